@@ -18,7 +18,9 @@ using json = nlohmann::json;
 /// ---------------------------------------- PUBLIC ---------------------------------------
 #pragma region PUBLIC
 
-Alert_Manager::Alert_Manager(dpp::cluster* bot) : bot_(bot), sent_msgs_(bot) {
+Alert_Manager::Alert_Manager(dpp::cluster* bot, std::string state_file)
+    : bot_(bot), state_file_(std::move(state_file)), sent_msgs_(bot), subscriptions_(bot),
+      board_(bot, [this]() { return board_entries(); }) {
     for (uint8_t type = personality::type::goods; type < personality::type::unknown; ++type) {
         alerts_info_.emplace_back(type);
     }
@@ -28,14 +30,10 @@ void Alert_Manager::add_active_auction(const active_auction& au) {
     std::unique_lock<std::shared_mutex> lock{mtx_};
     active_auctions_.push_back(au);
     auto time_left = std::chrono::abs(au.ends_at - system_clock::now());
-    logger->debug("Time left for {}: {}", au.p->name, util::fmt_to_hr_min_sec(time_left));
-
-    Alert_Info& alert = get_alert_by_type(au.p->info.ptype);
-    if (!alert.is_enabled()) {
-        return;
-    }
+    logger->debug("Time left for {}: {}", au.p->name(), util::fmt_to_hr_min_sec(time_left));
 
     update_alerts(au.p->info.ptype);
+    board_.request_update();
 }
 
 bool Alert_Manager::add_seen_auction_id(const std::string& id) {
@@ -44,6 +42,11 @@ bool Alert_Manager::add_seen_auction_id(const std::string& id) {
     return inserted;
 }
 
+void Alert_Manager::forget_seen_auction_id(const std::string& id) {
+    std::unique_lock<std::shared_mutex> lock{mtx_};
+    seen_auction_ids_.erase(id);
+}
+
 void Alert_Manager::set_alert_enabled(personality::type t, bool enabled) {
     std::unique_lock<std::shared_mutex> lock{mtx_};
     Alert_Info& alert = get_alert_by_type(t);
@@ -55,8 +58,10 @@ void Alert_Manager::set_alert_enabled(personality::type t, bool enabled) {
 
     logger->debug("{} alert for type {}", enabled ? "Enabling" : "Disabling", t.t);
     alert.set_enabled(enabled);
+    ++config_version_;
 
     update_alerts(t);
+    board_.request_update();
 }
 
 void Alert_Manager::set_alert_interval(personality::type t, int interval, bool enabled) {
@@ -71,6 +76,7 @@ void Alert_Manager::set_alert_interval(personality::type t, int interval, bool e
     } else {
         alert.disable_interval(interval);
     }
+    ++config_version_;
 
     update_alerts(t);
 }
@@ -86,7 +92,7 @@ bool Alert_Manager::is_interval_enabled(personality::type t, int interval) {
 }
 
 dpp::message Alert_Manager::build_alert_message(const personality& p, system_clock::time_point ends_at,
-                                                const std::string& custom_msg, int interval) {
+                                                const std::string& custom_msg, int interval, bool mention_role) {
     dpp::embed e = util::build_embed(ends_at, p);
     e.set_color(util::rnd_color());
 
@@ -102,17 +108,39 @@ dpp::message Alert_Manager::build_alert_message(const personality& p, system_clo
         .append(util::timepoint_to_discord_timestamp(ends_at, "t"))
         .append("\n**## ")
         .append(util::timepoint_to_discord_timestamp(ends_at))
-        .append("**")
-        .append(fmt::format("<@&{}>", static_cast<uint64_t>(alert_role_)));
-    m.set_channel_id(alert_channel_);
+        .append("**");
     m.add_embed(e);
-    m.allowed_mentions.parse_everyone = true;
-    m.allowed_mentions.parse_roles = true;
 
-    m.set_flags(dpp::m_ephemeral);
+    if (mention_role) {
+        m.content.append(fmt::format("<@&{}>", static_cast<uint64_t>(alert_role_)));
+        m.set_channel_id(alert_channel_);
+        m.allowed_mentions.parse_everyone = true;
+        m.allowed_mentions.parse_roles = true;
+        m.set_flags(dpp::m_ephemeral);
+    }
+
     return m;
 }
 
+bool Alert_Manager::set_subscription(dpp::snowflake user, personality::type t, int interval, bool enabled) {
+    if (!subscriptions_.subscribe(user, t, interval, enabled)) {
+        return false;
+    }
+
+    {
+        std::unique_lock<std::shared_mutex> lock{mtx_};
+        update_alerts(t);
+    }
+
+    // subscriptions are user data, a crash must not lose them
+    save_state();
+    return true;
+}
+
+bool Alert_Manager::is_subscribed(dpp::snowflake user, personality::type t, int interval) {
+    return subscriptions_.is_subscribed(user, t, interval);
+}
+
 std::string Alert_Manager::get_alert_message(personality::type t) {
     std::shared_lock<std::shared_mutex> lock{mtx_};
     return get_alert_by_type(t).msg();
@@ -122,10 +150,9 @@ void Alert_Manager::set_alert_message(personality::type t, const std::string& ms
     std::unique_lock<std::shared_mutex> lock{mtx_};
     auto& alert = get_alert_by_type(t);
     alert.set_msg(msg);
-    if (alert.is_enabled()) {
-        stop_timers(t);
-        update_alerts(t);
-    }
+    ++config_version_;
+    stop_timers(t);
+    update_alerts(t);
 }
 
 bool Alert_Manager::has_alert_message(personality::type t) {
@@ -142,6 +169,8 @@ void Alert_Manager::set_horizon_message(personality::type t, const std::string&
     std::unique_lock<std::shared_mutex> lock{mtx_};
     auto& alert = get_alert_by_type(t);
     alert.set_horizon_msg(msg);
+    ++config_version_;
+    board_.request_update();
 }
 
 bool Alert_Manager::has_horizon_message(personality::type t) {
@@ -157,6 +186,7 @@ dpp::snowflake Alert_Manager::get_alert_role() {
 void Alert_Manager::set_alert_role(dpp::snowflake role) {
     std::unique_lock<std::shared_mutex> lock{mtx_};
     alert_role_ = role;
+    ++config_version_;
 }
 
 dpp::snowflake Alert_Manager::get_alert_channel() {
@@ -167,6 +197,7 @@ dpp::snowflake Alert_Manager::get_alert_channel() {
 void Alert_Manager::set_alert_channel(dpp::snowflake channel) {
     std::unique_lock<std::shared_mutex> lock{mtx_};
     alert_channel_ = channel;
+    board_.set_channel(channel);
 }
 
 std::vector<Alert_Info> Alert_Manager::get_alerts_info() {
@@ -177,6 +208,7 @@ std::vector<Alert_Info> Alert_Manager::get_alerts_info() {
 void Alert_Manager::set_alerts_info(std::vector<Alert_Info> alerts_info) {
     std::unique_lock<std::shared_mutex> lock{mtx_};
     alerts_info_ = std::move(alerts_info);
+    ++config_version_;
 }
 
 void Alert_Manager::add_custom_message(const std::string& title, const std::string& msg) {
@@ -189,6 +221,7 @@ void Alert_Manager::add_custom_message(const std::string& title, const std::stri
     }
 
     custom_msgs_.emplace_back(id, title, msg);
+    ++config_version_;
 }
 
 void Alert_Manager::remove_custom_message(int id) {
@@ -197,6 +230,7 @@ void Alert_Manager::remove_custom_message(int id) {
     if (it != custom_msgs_.end()) {
         logger->info("Removed message id={}, title={}", it->id, it->title);
         custom_msgs_.erase(it);
+        ++config_version_;
     }
 }
 
@@ -208,6 +242,7 @@ std::vector<Custom_Message> Alert_Manager::get_custom_msgs() {
 void Alert_Manager::set_custom_msgs(std::vector<Custom_Message> custom_msgs) {
     std::unique_lock<std::shared_mutex> lock{mtx_};
     custom_msgs_ = std::move(custom_msgs);
+    ++config_version_;
 }
 
 bool Alert_Manager::set_custom_msg_for_alert(personality::type t, int id) {
@@ -247,7 +282,7 @@ bool Alert_Manager::has_custom_msgs() {
 }
 
 bool Alert_Manager::load_state() {
-    std::ifstream f{s_alert_manager_file};
+    std::ifstream f{state_file_};
     if (f.is_open()) {
         try {
             json j = json::parse(f);
@@ -260,14 +295,22 @@ bool Alert_Manager::load_state() {
                 auto custom_msgs = j.at("custom_msgs").get<std::vector<Custom_Message>>();
                 set_custom_msgs(std::move(custom_msgs));
             }
-            logger->info("Successfully loaded alert manager state from file");
+
+            if (j.contains("subscriptions")) {
+                subscriptions_.load(j.at("subscriptions"));
+            }
+
+            if (j.contains("board")) {
+                board_.load(j.at("board"));
+            }
+            logger->info("Successfully loaded alert manager state from {}", state_file_);
             return true;
         } catch (const json::exception& e) {
             logger->warn("Parsing state json(load) failed with: {}", e.what());
             return false;
         }
     } else {
-        logger->error("Failed to open the alert manager file (on load)");
+        logger->error("Failed to open the alert manager file {} (on load)", state_file_);
     }
 
     logger->warn("Using default alert manager state");
@@ -275,26 +318,43 @@ bool Alert_Manager::load_state() {
 }
 
 bool Alert_Manager::save_state() {
-    std::ofstream f{s_alert_manager_file};
+    std::lock_guard<std::mutex> save_lock{save_mtx_};
+    std::ofstream f{state_file_};
     if (f.is_open()) {
         try {
             json j;
             j["alerts_info"] = get_alerts_info();
             j["custom_msgs"] = get_custom_msgs();
+            j["subscriptions"] = subscriptions_.save();
+            j["board"] = board_.save();
             f << j;
         } catch (const json::exception& e) {
             logger->warn("Parsing state json(save) failed with: {}", e.what());
             return false;
         }
     } else {
-        logger->error("Failed to open the alert manager state file (on save)");
+        logger->error("Failed to open the alert manager state file {} (on save)", state_file_);
         return false;
     }
 
-    logger->info("Successfully saved the alert manager state");
+    logger->info("Successfully saved the alert manager state to {}", state_file_);
     return true;
 }
 
+size_t Alert_Manager::active_auction_count() {
+    std::shared_lock<std::shared_mutex> lock{mtx_};
+    return active_auctions_.size();
+}
+
+size_t Alert_Manager::armed_timer_count() {
+    std::shared_lock<std::shared_mutex> lock{mtx_};
+    size_t n = 0;
+    for (const auto& au : active_auctions_) {
+        n += au.timers_.size();
+    }
+    return n;
+}
+
 void Alert_Manager::reset_alerts() {
     std::unique_lock<std::shared_mutex> lock{mtx_};
     for (auto& au : active_auctions_) {
@@ -304,15 +364,19 @@ void Alert_Manager::reset_alerts() {
     active_auctions_.clear();
     seen_auction_ids_.clear();
     sent_msgs_.delete_all_messages();
+    board_.request_update();
 }
 
 void Alert_Manager::refresh_active_auctions() {
     std::unique_lock<std::shared_mutex> lock{mtx_};
 
     // todo remove seen id
-    active_auctions_.erase(std::remove_if(active_auctions_.begin(), active_auctions_.end(),
-                                          [](active_auction& au) { return au.has_ended(); }),
-                           active_auctions_.end());
+    auto ended = std::remove_if(active_auctions_.begin(), active_auctions_.end(),
+                                [](active_auction& au) { return au.has_ended(); });
+    if (ended != active_auctions_.end()) {
+        active_auctions_.erase(ended, active_auctions_.end());
+        board_.request_update();
+    }
 }
 
 #pragma endregion PUBLIC
@@ -336,6 +400,29 @@ void Alert_Manager::add_timer(const std::string& id, int interval, dpp::timer ti
     }
 }
 
+dpp::timer Alert_Manager::arm_alert(const active_auction& au, int interval, const std::string& custom_msg,
+                                    uint64_t seconds) {
+    auto p = au.p;
+    const auto ends_at = au.client_ends_at();
+    Alert_Data data{seconds, interval, build_alert_message(*p, ends_at, custom_msg, interval)};
+
+    // channel alert and subscriptions are checked when the timer fires, either may have changed since
+    return util::one_shot_timer(
+        bot_,
+        [this, data, p, ends_at, custom_msg]() {
+            const personality::type t = p->info.ptype;
+            if (is_alert_enabled(t) && is_interval_enabled(t, data.interval)) {
+                util::send_alert(bot_, data, &sent_msgs_);
+            }
+
+            if (subscriptions_.has_subscribers(t, data.interval)) {
+                subscriptions_.fan_out(t, data.interval,
+                                       build_alert_message(*p, ends_at, custom_msg, data.interval, false));
+            }
+        },
+        seconds);
+}
+
 void Alert_Manager::stop_timers(const std::string& id) {
     auto it =
         std::find_if(active_auctions_.begin(), active_auctions_.end(), [&](const auto& au) { return au.id == id; });
@@ -362,6 +449,25 @@ void Alert_Manager::stop_timers(personality::type t) {
     }
 }
 
+std::vector<Board_Entry> Alert_Manager::board_entries() {
+    std::shared_lock<std::shared_mutex> lock{mtx_};
+    std::vector<Board_Entry> entries;
+    entries.reserve(active_auctions_.size());
+
+    for (auto& au : active_auctions_) {
+        if (au.has_ended()) {
+            continue;
+        }
+
+        const Alert_Info& alert = get_alert_by_type(au.p->info.ptype);
+        entries.push_back({au.p, au.client_ends_at(), alert.is_enabled(), alert.horizon_msg()});
+    }
+
+    std::sort(entries.begin(), entries.end(),
+              [](const Board_Entry& a, const Board_Entry& b) { return a.ends_at < b.ends_at; });
+    return entries;
+}
+
 void Alert_Manager::update_alerts(personality::type t) {
     for (auto& ac_auction : active_auctions_) {
         if (ac_auction.has_ended() || ac_auction.p->info.ptype != t) {
@@ -370,7 +476,8 @@ void Alert_Manager::update_alerts(personality::type t) {
 
         Alert_Info& alert = get_alert_by_type(t);
         for (int interval : Alert_Info::s_intervals) {
-            if (alert.interval_is_enabled(interval) && alert.is_enabled()) {
+            bool channel_alert = alert.interval_is_enabled(interval) && alert.is_enabled();
+            if (channel_alert || subscriptions_.has_subscribers(t, interval)) {
                 if (ac_auction.has_interval_timer(interval)) {
                     continue;
                 } else {
@@ -379,15 +486,11 @@ void Alert_Manager::update_alerts(personality::type t) {
                     }
 
                     auto delay = ac_auction.wait_delay_for_interval(interval);
-                    logger->debug("Alert in: {} {}", util::fmt_to_hr_min_sec(delay), ac_auction.p->name);
+                    logger->debug("Alert in: {} {}", util::fmt_to_hr_min_sec(delay), ac_auction.p->name());
 
                     add_timer(ac_auction.id, interval,
-                              util::make_alert(
-                                  bot_,
-                                  Alert_Data{static_cast<uint64_t>(duration_cast<seconds>(delay).count()), interval,
-                                             build_alert_message(*ac_auction.p, ac_auction.client_ends_at(),
-                                                                 alert.msg(), interval)},
-                                  &sent_msgs_));
+                              arm_alert(ac_auction, interval, alert.msg(),
+                                        static_cast<uint64_t>(duration_cast<seconds>(delay).count())));
                 }
             } else {
                 if (!ac_auction.has_interval_timer(interval)) {
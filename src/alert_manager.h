@@ -1,6 +1,7 @@
 #ifndef ALERT_MANAGER_H
 #define ALERT_MANAGER_H
 
+#include <atomic>
 #include <chrono>
 #include <mutex>
 #include <string>
@@ -12,6 +13,8 @@
 #include "alert_info.h"
 #include "message_tracker.h"
 #include "personality.h"
+#include "status_board.h"
+#include "subscription_manager.h"
 
 namespace railcord {
 
@@ -19,7 +22,7 @@ inline constexpr const char* s_alert_manager_file{"state.json"};
 
 class Alert_Manager {
   public:
-    Alert_Manager(dpp::cluster* bot);
+    Alert_Manager(dpp::cluster* bot, std::string state_file = s_alert_manager_file);
     Alert_Manager(const Alert_Manager&) = delete;
     Alert_Manager(Alert_Manager&&) = delete;
     Alert_Manager& operator=(const Alert_Manager&) = delete;
@@ -27,6 +30,7 @@ class Alert_Manager {
 
     void add_active_auction(const active_auction& au);
     bool add_seen_auction_id(const std::string& id);
+    void forget_seen_auction_id(const std::string& id);   // the next poll treats it as new again
 
     void set_alert_enabled(personality::type t, bool enabled);
     void set_alert_interval(personality::type t, int interval, bool enabled);
@@ -34,7 +38,10 @@ class Alert_Manager {
     bool is_interval_enabled(personality::type, int interval);
 
     dpp::message build_alert_message(const personality& p, std::chrono::system_clock::time_point ends_at,
-                                     const std::string& custom_msg, int interval);
+                                     const std::string& custom_msg, int interval, bool mention_role = true);
+
+    bool set_subscription(dpp::snowflake user, personality::type t, int interval, bool enabled);
+    bool is_subscribed(dpp::snowflake user, personality::type t, int interval);
 
     std::string get_alert_message(personality::type t);
     void set_alert_message(personality::type t, const std::string& msg);
@@ -50,6 +57,9 @@ class Alert_Manager {
     dpp::snowflake get_alert_channel();
     void set_alert_channel(dpp::snowflake channel);
 
+    bool board_enabled() { return board_.is_enabled(); }
+    void set_board_enabled(bool enabled) { board_.set_enabled(enabled); }
+
     std::vector<Alert_Info> get_alerts_info();
     void set_alerts_info(std::vector<Alert_Info> alerts_info);
 
@@ -63,21 +73,33 @@ class Alert_Manager {
     bool set_custom_msg_for_horizon(personality::type t, int id);
     bool has_custom_msgs();
 
+    // Bumped after every change to the alerts or custom messages, menus rendered from them are cached by it
+    uint64_t config_version() const { return config_version_.load(); }
+
     bool load_state();
-    bool save_state();
+    bool save_state();   // also after every subscription change, callers may race
 
     void reset_alerts();
     void refresh_active_auctions();
 
+    size_t active_auction_count();
+    size_t armed_timer_count();   // alert timers of the active auctions
+    size_t tracked_message_count() { return sent_msgs_.size(); }
+
   private:
     Alert_Info& get_alert_by_type(personality::type t);
     void add_timer(const std::string& id, int interval, dpp::timer timer);
+    dpp::timer arm_alert(const active_auction& au, int interval, const std::string& custom_msg, uint64_t seconds);
     void stop_timers(const std::string& id);
     void stop_timers(personality::type t);
     void update_alerts(personality::type t);
+    std::vector<Board_Entry> board_entries();
 
     std::shared_mutex mtx_;
+    std::mutex save_mtx_;   // one writer of state_file_ at a time
+    std::atomic<uint64_t> config_version_{0};
     dpp::cluster* bot_;
+    std::string state_file_;
 
     std::vector<Alert_Info> alerts_info_;
     std::vector<active_auction> active_auctions_;
@@ -87,6 +109,8 @@ class Alert_Manager {
     dpp::snowflake alert_channel_;
     MessageTracker sent_msgs_;
     std::vector<Custom_Message> custom_msgs_;
+    Subscription_Manager subscriptions_;
+    Status_Board board_;
 };
 
 }   // namespace railcord
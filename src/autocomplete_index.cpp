@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <cctype>
+#include <numeric>
+
+#include <dpp/appcommand.h>
+#include <dpp/nlohmann/json.hpp>
+
+#include "autocomplete_index.h"
+
+namespace railcord {
+
+static void fold_into(std::string_view s, std::string& out) {
+    out.assign(s.begin(), s.end());
+    std::transform(out.begin(), out.end(), out.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+}
+
+// Edit distance between the query and the closest start of a name
+static size_t prefix_distance(std::string_view query, std::string_view name, std::vector<size_t>& row) {
+    name = name.substr(0, query.size() * 2);
+    row.resize(name.size() + 1);
+    std::iota(row.begin(), row.end(), size_t{0});
+
+    for (size_t i = 1; i <= query.size(); ++i) {
+        size_t diagonal = row[0];
+        row[0] = i;
+        for (size_t j = 1; j <= name.size(); ++j) {
+            const size_t above = row[j];
+            row[j] = std::min({row[j] + 1, row[j - 1] + 1, diagonal + (query[i - 1] == name[j - 1] ? 0 : 1)});
+            diagonal = above;
+        }
+    }
+    return *std::min_element(row.begin(), row.end());
+}
+
+Autocomplete_Index::Autocomplete_Index(std::vector<Choice> choices) : choices_(std::move(choices)) {
+    folded_.resize(choices_.size());
+    json_.resize(choices_.size());
+    for (size_t i = 0; i < choices_.size(); ++i) {
+        fold_into(choices_[i].name, folded_[i]);
+        json_[i] = nlohmann::json{{"name", choices_[i].name}, {"value", choices_[i].value}}.dump();
+    }
+
+    sorted_.resize(choices_.size());
+    std::iota(sorted_.begin(), sorted_.end(), uint32_t{0});
+    std::sort(sorted_.begin(), sorted_.end(), [this](uint32_t a, uint32_t b) { return folded_[a] < folded_[b]; });
+
+    // the short prefixes are what most keystrokes ask for
+    std::vector<uint32_t> matches;
+    const auto cache = [&](std::string prefix) {
+        if (cached_.count(prefix)) {
+            return;
+        }
+        match(prefix, matches);
+        std::string res;
+        fill(res, matches);
+        cached_.emplace(std::move(prefix), std::move(res));
+    };
+
+    cache({});
+    for (const auto& name : folded_) {
+        for (size_t len = 1; len <= std::min(s_cached_prefix, name.size()); ++len) {
+            cache(name.substr(0, len));
+        }
+    }
+}
+
+const std::string& Autocomplete_Index::reply(std::string_view input) const {
+    thread_local std::string folded;
+    thread_local std::vector<uint32_t> matches;
+    thread_local std::string res;
+
+    fold_into(input, folded);
+    if (folded.size() <= s_cached_prefix) {
+        if (auto found = cached_.find(folded); found != cached_.end()) {
+            return found->second;
+        }
+    }
+
+    match(folded, matches);
+    fill(res, matches);
+    return res;
+}
+
+void Autocomplete_Index::match(std::string_view folded, std::vector<uint32_t>& out) const {
+    out.clear();
+
+    // prefix matches are one contiguous range of the sorted index
+    const auto by_name = [this](uint32_t idx) { return std::string_view{folded_[idx]}; };
+    auto first = std::lower_bound(sorted_.begin(), sorted_.end(), folded,
+                                  [&](uint32_t idx, std::string_view q) { return by_name(idx) < q; });
+    for (auto it = first; it != sorted_.end() && out.size() < s_max_choices; ++it) {
+        if (by_name(*it).substr(0, folded.size()) != folded) {
+            break;
+        }
+        out.push_back(*it);
+    }
+
+    if (!out.empty()) {
+        return;
+    }
+
+    for (uint32_t idx : sorted_) {
+        if (by_name(idx).find(folded) != std::string_view::npos) {
+            out.push_back(idx);
+            if (out.size() == s_max_choices) {
+                return;
+            }
+        }
+    }
+
+    if (!out.empty()) {
+        return;
+    }
+
+    // typos, closest first
+    thread_local std::vector<size_t> row;
+    thread_local std::vector<std::pair<size_t, uint32_t>> ranked;
+    ranked.clear();
+    const size_t max_distance = std::max<size_t>(1, folded.size() / 3);
+    for (uint32_t idx : sorted_) {
+        const size_t distance = prefix_distance(folded, by_name(idx), row);
+        if (distance <= max_distance) {
+            ranked.emplace_back(distance, idx);
+        }
+    }
+
+    std::stable_sort(ranked.begin(), ranked.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+    for (size_t i = 0; i < ranked.size() && i < s_max_choices; ++i) {
+        out.push_back(ranked[i].second);
+    }
+}
+
+// Appends the prebuilt choice objects, the buffer keeps its capacity so a keystroke does not allocate
+void Autocomplete_Index::fill(std::string& res, const std::vector<uint32_t>& matches) const {
+    res.assign(R"({"type":)").append(std::to_string(dpp::ir_autocomplete_reply)).append(R"(,"data":{"choices":[)");
+    for (size_t i = 0; i < matches.size(); ++i) {
+        if (i) {
+            res.push_back(',');
+        }
+        res.append(json_[matches[i]]);
+    }
+    res.append("]}}");
+}
+
+}   // namespace railcord
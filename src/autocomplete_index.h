@@ -0,0 +1,45 @@
+#ifndef AUTOCOMPLETE_INDEX_H
+#define AUTOCOMPLETE_INDEX_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace railcord {
+
+// Case folded choices of an autocomplete option. Prefix matches come from a sorted index, substring and then
+// fuzzy matches are the fallback. Replies are the serialized interaction response, the ones for every prefix up
+// to s_cached_prefix chars are built up front
+class Autocomplete_Index {
+  public:
+    struct Choice {
+        std::string name;
+        std::string value;
+    };
+
+    Autocomplete_Index() = default;
+    explicit Autocomplete_Index(std::vector<Choice> choices);
+
+    // The json body of the reply, cached or built in a per thread buffer that stays valid until the next call on
+    // that thread
+    const std::string& reply(std::string_view input) const;
+
+    static constexpr size_t s_max_choices = 25;   // discord limit
+    static constexpr size_t s_cached_prefix = 2;
+
+  private:
+    void match(std::string_view folded, std::vector<uint32_t>& out) const;
+    void fill(std::string& res, const std::vector<uint32_t>& matches) const;
+
+    std::vector<Choice> choices_;
+    std::vector<std::string> folded_;   // parallel to choices_
+    std::vector<std::string> json_;     // parallel to choices_, each choice as a json object
+    std::vector<uint32_t> sorted_;      // choice indices by folded name
+    std::unordered_map<std::string, std::string> cached_;
+};
+
+}   // namespace railcord
+
+#endif   // !AUTOCOMPLETE_INDEX_H
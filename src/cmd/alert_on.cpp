@@ -12,25 +12,64 @@ namespace railcord::cmd {
 using namespace std::chrono;
 
 constexpr const char* prefix_alert_on = "alert";
-constexpr const char* on_enable = "enable";
-constexpr const char* on_back = "back";
-constexpr const char* on_add_alert_msg = "setmsg";
-constexpr const char* on_select_alert_msg = "selectmsg";
-constexpr const char* on_preview = "preview";
-constexpr const char* on_timer = "timer";
-constexpr const char* on_select_click = "selectclick";
-constexpr const char* on_form_submit = "formsubmit";
-
-constexpr const char* on_select_menu1 = "main_menu";
-constexpr const char* on_select_menu2 = "cmsg_menu";
-constexpr const char* on_select_menu3 = "hmsg_menu";
-
-constexpr const char* on_custom_msg = "custommsg";
-constexpr const char* on_horizon_msg = "horizonmsg";
-
-static std::vector<dpp::component> build_personality_btns(Lucy* lucy, personality::type t) {
-    Alert_Manager* alert_manager = lucy->alert_manager();
-    const GameData* g = lucy->gamedata();
+
+// Every id starts with the world index, see World_Set::at
+enum class Alert_Action : char {
+    enable = 'e',             // world, type, enabled
+    back = 'b',               // world
+    add_alert_msg = 'a',      // world, type
+    select_alert_msg = 's',   // world, type
+    preview = 'p',            // world, type
+    timer = 't',              // world, type, interval, enabled
+    select_click = 'c',       // world, menu, type
+    form_submit = 'f',        // world, form
+    horizon_msg = 'h'         // world, type
+};
+
+// button_menu is only a menus_ key
+enum Alert_Menu : uint8_t { main_menu = 1, cmsg_menu = 2, hmsg_menu = 3, button_menu = 4 };
+enum Alert_Form : uint8_t { custom_msg_form = 1 };
+
+using Alert_Id = Custom_Id<Alert_Action>;
+
+static constexpr uint8_t field_count(Alert_Action action) {
+    switch (action) {
+        case Alert_Action::back:
+            return 1;
+        case Alert_Action::add_alert_msg:
+        case Alert_Action::select_alert_msg:
+        case Alert_Action::preview:
+        case Alert_Action::form_submit:
+        case Alert_Action::horizon_msg:
+            return 2;
+        case Alert_Action::enable:
+        case Alert_Action::select_click:
+            return 3;
+        case Alert_Action::timer:
+            return 4;
+    }
+    return UINT8_MAX;   // unknown tag
+}
+
+// Empty for ids of another prefix, unknown actions or the wrong number of fields
+static std::optional<Alert_Id> decode_alert_id(const std::string& custom_id) {
+    auto id = Alert_Id::decode(custom_id, prefix_alert_on);
+    if (!id || id->field_count != field_count(id->action)) {
+        logger->warn("Malformed alert id \"{}\"", custom_id);
+        return {};
+    }
+    return id;
+}
+
+// The game mode of the world, loaded while its watcher runs
+static Dataset_Ptr world_data(Lucy* lucy, World* world) {
+    return lucy->gamedata_registry()->get(world->game_mode())->snapshot();
+}
+
+static std::vector<dpp::component> build_personality_btns(Lucy* lucy, World* world, personality::type t) {
+    Alert_Manager* alert_manager = world->alert_manager();
+    auto g = world_data(lucy, world);
+    const uint8_t w = world_field(world, lucy);
 
     bool alerts_enabled = alert_manager->is_alert_enabled(t);
     const dpp::emoji& emoji = g->get_emoji(t);
@@ -44,7 +83,7 @@ static std::vector<dpp::component> build_personality_btns(Lucy* lucy, personalit
                 .set_emoji(back_emoji.name, back_emoji.id)
                 .set_style(dpp::cos_secondary)
                 .set_type(dpp::cot_button)
-                .set_id(build_id(prefix_alert_on, on_back));
+                .set_id(Alert_Id::encode(prefix_alert_on, Alert_Action::back, w));
         btns.push_back(back);
     }
 
@@ -57,8 +96,7 @@ static std::vector<dpp::component> build_personality_btns(Lucy* lucy, personalit
         enable_disable_alert.set_type(dpp::cot_button);
         enable_disable_alert.set_label(alerts_enabled ? "Disable" : "Enable");
         enable_disable_alert.set_emoji(emoji.name, emoji.id);
-        enable_disable_alert.set_id(
-            build_id(prefix_alert_on, on_enable, std::to_string(t.t), std::to_string(alerts_enabled)));
+        enable_disable_alert.set_id(Alert_Id::encode(prefix_alert_on, Alert_Action::enable, w, t.t, alerts_enabled));
         btns.push_back(enable_disable_alert);
     }
 
@@ -72,7 +110,7 @@ static std::vector<dpp::component> build_personality_btns(Lucy* lucy, personalit
         set_alert_msg.set_type(dpp::cot_button);
         set_alert_msg.set_label("Add message");
         set_alert_msg.set_emoji(dpp::unicode_emoji::scroll);
-        set_alert_msg.set_id(build_id(prefix_alert_on, on_add_alert_msg, std::to_string(t.t)));
+        set_alert_msg.set_id(Alert_Id::encode(prefix_alert_on, Alert_Action::add_alert_msg, w, t.t));
         btns.push_back(set_alert_msg);
     }
 
@@ -87,7 +125,7 @@ static std::vector<dpp::component> build_personality_btns(Lucy* lucy, personalit
         preview_alert.set_label("Preview");
         preview_alert.set_emoji(dpp::unicode_emoji::eye);
         preview_alert.set_disabled(!alert_manager->has_alert_message(t));
-        preview_alert.set_id(build_id(prefix_alert_on, on_preview, std::to_string(t.t)));
+        preview_alert.set_id(Alert_Id::encode(prefix_alert_on, Alert_Action::preview, w, t.t));
 
         btns.push_back(preview_alert);
     }
@@ -101,7 +139,7 @@ static std::vector<dpp::component> build_personality_btns(Lucy* lucy, personalit
         select_alert_msg.set_label("Alert message");
         select_alert_msg.set_emoji(dpp::unicode_emoji::calendar_spiral);
         select_alert_msg.set_disabled(!alert_manager->has_custom_msgs());
-        select_alert_msg.set_id(build_id(prefix_alert_on, on_select_alert_msg, std::to_string(t.t)));
+        select_alert_msg.set_id(Alert_Id::encode(prefix_alert_on, Alert_Action::select_alert_msg, w, t.t));
 
         btns.push_back(select_alert_msg);
     }
@@ -117,8 +155,7 @@ static std::vector<dpp::component> build_personality_btns(Lucy* lucy, personalit
             btn.set_type(dpp::cot_button);
             btn.set_label(std::to_string(m < 60 ? m : m / 60) + (m < 60 ? "m" : "h") + (enabled ? " (on)" : " (off)"));
             btn.set_emoji(dpp::unicode_emoji::timer_clock);
-            btn.set_id(
-                build_id(prefix_alert_on, on_timer, std::to_string(t.t), std::to_string(m), std::to_string(enabled)));
+            btn.set_id(Alert_Id::encode(prefix_alert_on, Alert_Action::timer, w, t.t, m, enabled));
             btns.push_back(btn);
         }
     }
@@ -132,7 +169,7 @@ static std::vector<dpp::component> build_personality_btns(Lucy* lucy, personalit
         on_the_horizon_message.set_label("Horizon message");
         on_the_horizon_message.set_emoji(dpp::unicode_emoji::railroad_track);
         on_the_horizon_message.set_disabled(!alert_manager->has_custom_msgs());
-        on_the_horizon_message.set_id(build_id(prefix_alert_on, on_horizon_msg, std::to_string(t.t)));
+        on_the_horizon_message.set_id(Alert_Id::encode(prefix_alert_on, Alert_Action::horizon_msg, w, t.t));
 
         btns.push_back(on_the_horizon_message);
     }
@@ -141,9 +178,10 @@ static std::vector<dpp::component> build_personality_btns(Lucy* lucy, personalit
     return btns;
 }
 
-static dpp::message build_select_menu_message(Lucy* lucy) {
-    GameData* g = lucy->gamedata();
-    Alert_Manager* alert_manager = lucy->alert_manager();
+static dpp::message build_select_menu_message(Lucy* lucy, World* world) {
+    auto g = world_data(lucy, world);
+    Alert_Manager* alert_manager = world->alert_manager();
+    const uint8_t w = world_field(world, lucy);
     const auto& pEffects = g->personality_effects();
 
     std::vector<dpp::select_option> options;
@@ -156,10 +194,11 @@ static dpp::message build_select_menu_message(Lucy* lucy) {
         bool enabled = alert_manager->is_alert_enabled(t);
 
         auto& emplaced =
-            options.emplace_back(iter->name + (enabled ? " (on)" : " (off)"), std::to_string(idx), t.description());
+            options.emplace_back(std::string{iter->name}.append(enabled ? " (on)" : " (off)"), std::to_string(idx),
+                                 t.description());
 
         if (iter->emoji) {
-            emplaced.set_emoji(iter->emoji->name, iter->emoji->id);
+            emplaced.set_emoji(std::string{iter->emoji->name}, iter->emoji->id);
         }
 
         ++idx;
@@ -170,7 +209,7 @@ static dpp::message build_select_menu_message(Lucy* lucy) {
         dpp::component()
             .set_type(dpp::cot_selectmenu)
             .set_placeholder("Configure alerts")
-            .set_id(build_id(prefix_alert_on, on_select_click, on_select_menu1));
+            .set_id(Alert_Id::encode(prefix_alert_on, Alert_Action::select_click, w, main_menu, 0));
     for (auto&& opt : options) {
         select_menu.add_select_option(opt);
     }
@@ -182,8 +221,9 @@ static dpp::message build_select_menu_message(Lucy* lucy) {
     return m;
 }
 
-static dpp::message build_custom_message_menu(Lucy* lucy, personality::type t, const char* menu) {
-    Alert_Manager* alert_manager = lucy->alert_manager();
+static dpp::message build_custom_message_menu(Lucy* lucy, World* world, personality::type t, Alert_Menu menu) {
+    Alert_Manager* alert_manager = world->alert_manager();
+    const uint8_t w = world_field(world, lucy);
     std::vector<dpp::select_option> options;
     auto custom_msgs = alert_manager->get_custom_msgs();
 
@@ -199,8 +239,8 @@ static dpp::message build_custom_message_menu(Lucy* lucy, personality::type t, c
     auto select_menu =
         dpp::component()
             .set_type(dpp::cot_selectmenu)
-            .set_placeholder(fmt::format("Select message: {}", menu == on_select_menu3 ? "Horizon" : "Alerts"))
-            .set_id(build_id(prefix_alert_on, on_select_click, menu, std::to_string(t.t)));
+            .set_placeholder(fmt::format("Select message: {}", menu == hmsg_menu ? "Horizon" : "Alerts"))
+            .set_id(Alert_Id::encode(prefix_alert_on, Alert_Action::select_click, w, menu, t.t));
     for (auto&& opt : options) {
         select_menu.add_select_option(opt);
     }
@@ -212,163 +252,206 @@ static dpp::message build_custom_message_menu(Lucy* lucy, personality::type t, c
     return m;
 }
 
-Alert_on::Alert_on(Lucy* lu) : Base_Cmd("alert_on", "Alerts before worker auction ends", seconds{5}, lu) {}
+Alert_on::Alert_on(Lucy* lu)
+    : Base_Cmd("alert_on", "Alerts before worker auction ends", seconds{5}, lu), menus_(lu->worlds()->all().size()) {}
 
-dpp::slashcommand Alert_on::build() { return dpp::slashcommand(name_, description_, lucy_->bot.me.id); }
+dpp::slashcommand Alert_on::build() {
+    return add_world_option(dpp::slashcommand(name_, description_, lucy_->bot.me.id), lucy_);
+}
 
 void Alert_on::handle_slash_interaction(const dpp::slashcommand_t& event) {
-    event.reply(build_select_menu_message(lucy_));
+    World* world = selected_world(event, lucy_);
+    if (!world) {
+        reply(event, dpp::message{"Unknown world!"}.set_flags(dpp::m_ephemeral));
+        return;
+    }
+
+    reply(event, *menu(world, main_menu));
 }
 
 void Alert_on::handle_button_click(const dpp::button_click_t& event) {
-
-    const std::string& id = event.custom_id;
-    Alert_Manager* alert_manager = lucy_->alert_manager();
-    std::string param{id.substr(id.find(handler_prefix_sep) + 1)};
-    // logger->info("got param {}", param);
-    auto args = extract_args(param);
-    // logger->info("got args {}", fmt::join(args, ","));
-
-    if (util::starts_with(param, on_back)) {
-        event.reply(dpp::ir_update_message, build_select_menu_message(lucy_));
+    auto id = decode_alert_id(event.custom_id);
+    World* world = id ? lucy_->worlds()->at((*id)[0]) : nullptr;
+    if (!world) {
+        reply(event);
         return;
-    } else if (util::starts_with(param, on_add_alert_msg)) {
-        dpp::interaction_modal_response modal(
-            build_id(prefix_alert_on, on_form_submit, on_custom_msg), "Alert message");
-        modal.add_component(
-            dpp::component()
-                .set_label("Title")
-                .set_id("title_field")
-                .set_type(dpp::cot_text)
-                .set_max_length(128)
-                .set_text_style(dpp::text_short));
-        modal.add_row();
-        modal.add_component(
-            dpp::component()
-                .set_label("Message")
-                .set_id("msg_field")
-                .set_type(dpp::cot_text)
-                .set_max_length(2048)
-                .set_text_style(dpp::text_paragraph));
+    }
 
-        event.dialog(modal);
-        return;
-    } else if (util::starts_with(param, on_horizon_msg)) {
-        // dpp::interaction_modal_response modal(
-        //     build_id(prefix_alert_on, alert_on_form_submit, alert_on_horizon_msg), "Horizon message");
-        // modal.add_component(
-        //     dpp::component()
-        //         .set_label("Horizon message")
-        //         .set_id("msg_field")
-        //         .set_type(dpp::cot_text)
-        //         .set_max_length(2048)
-        //         .set_text_style(dpp::text_paragraph));
-
-        // event.dialog(modal);
-
-        personality::type t{std::stoi(args.front())};
-        event.reply(dpp::ir_update_message, build_custom_message_menu(lucy_, t, on_select_menu3));
-        return;
-    } else if (util::starts_with(param, on_enable)) {
-        personality::type t{std::stoi(args.front())};
-        bool is_enabled = std::stoi(args.back());
-        alert_manager->set_alert_enabled(t, !is_enabled);
-        event.reply(dpp::ir_update_message, build_button_menu_msg(t));
-        return;
-    } else if (util::starts_with(param, on_timer)) {
-        personality::type t{std::stoi(args.front())};
-        int interval = std::stoi(args[1]);
-        bool enabled = std::stoi(args.back());
-        alert_manager->set_alert_interval(t, interval, !enabled);
-        event.reply(dpp::ir_update_message, build_button_menu_msg(t));
-        return;
-    } else if (util::starts_with(param, on_preview)) {
-        event.thinking();
-        personality::type t{std::stoi(args.front())};
-        event.edit_original_response(
-            alert_manager->build_alert_message(
-                lucy_->gamedata()->get_rnd_personality(t), system_clock::now() + minutes{5},
-                alert_manager->get_alert_message(t), 5),
-            [bot = &lucy_->bot](const dpp::confirmation_callback_t& cc) {
-                if (!cc.is_error()) {
-                    const dpp::message& m = cc.get<dpp::message>();
-                    util::one_shot_timer(
-                        bot,
-                        [sent_msg = SentMessage{m.id, m.channel_id}, bot]() {
-                            logger->info("Deleting msg(preview) id = {}", static_cast<uint64_t>(sent_msg.id));
-                            bot->message_delete(sent_msg.id, sent_msg.channel_id);
-                        },
-                        60u);
-                }
-            });
-        return;
-    } else if (util::starts_with(param, on_select_alert_msg)) {
-        personality::type t{std::stoi(args.front())};
-        event.reply(dpp::ir_update_message, build_custom_message_menu(lucy_, t, on_select_menu2));
-        return;
+    Alert_Manager* alert_manager = world->alert_manager();
+
+    switch (id->action) {
+        case Alert_Action::back: {
+            reply(event, dpp::ir_update_message, *menu(world, main_menu));
+            return;
+        }
+        case Alert_Action::add_alert_msg: {
+            dpp::interaction_modal_response modal(
+                Alert_Id::encode(prefix_alert_on, Alert_Action::form_submit, (*id)[0], custom_msg_form),
+                "Alert message");
+            modal.add_component(
+                dpp::component()
+                    .set_label("Title")
+                    .set_id("title_field")
+                    .set_type(dpp::cot_text)
+                    .set_max_length(128)
+                    .set_text_style(dpp::text_short));
+            modal.add_row();
+            modal.add_component(
+                dpp::component()
+                    .set_label("Message")
+                    .set_id("msg_field")
+                    .set_type(dpp::cot_text)
+                    .set_max_length(2048)
+                    .set_text_style(dpp::text_paragraph));
+
+            dialog(event, modal);
+            return;
+        }
+        case Alert_Action::horizon_msg: {
+            personality::type t{(*id)[1]};
+            reply(event, dpp::ir_update_message, *menu(world, hmsg_menu, t));
+            return;
+        }
+        case Alert_Action::enable: {
+            personality::type t{(*id)[1]};
+            bool is_enabled = (*id)[2];
+            alert_manager->set_alert_enabled(t, !is_enabled);
+            reply(event, dpp::ir_update_message, *menu(world, button_menu, t));
+            return;
+        }
+        case Alert_Action::timer: {
+            personality::type t{(*id)[1]};
+            int interval = (*id)[2];
+            bool enabled = (*id)[3];
+            alert_manager->set_alert_interval(t, interval, !enabled);
+            reply(event, dpp::ir_update_message, *menu(world, button_menu, t));
+            return;
+        }
+        case Alert_Action::preview: {
+            defer(event);
+            personality::type t{(*id)[1]};
+            reply(
+                event,
+                alert_manager->build_alert_message(world_data(lucy_, world)->get_rnd_personality(t),
+                                                   system_clock::now() + minutes{5},
+                                                   alert_manager->get_alert_message(t), 5),
+                [bot = &lucy_->bot](const dpp::confirmation_callback_t& cc) {
+                    if (!cc.is_error()) {
+                        const dpp::message& m = cc.get<dpp::message>();
+                        util::one_shot_timer(
+                            bot,
+                            [sent_msg = SentMessage{m.id, m.channel_id}, bot]() {
+                                logger->info("Deleting msg(preview) id = {}", static_cast<uint64_t>(sent_msg.id));
+                                bot->message_delete(sent_msg.id, sent_msg.channel_id);
+                            },
+                            60u);
+                    }
+                });
+            return;
+        }
+        case Alert_Action::select_alert_msg: {
+            personality::type t{(*id)[1]};
+            reply(event, dpp::ir_update_message, *menu(world, cmsg_menu, t));
+            return;
+        }
+        default:
+            break;
     }
 
-    event.reply();
+    reply(event);
 }
 
 void Alert_on::handle_select_click(const dpp::select_click_t& event) {
-    auto args = extract_args(event.custom_id);
-    personality::type t;
+    auto id = decode_alert_id(event.custom_id);
+    World* world = id && id->action == Alert_Action::select_click ? lucy_->worlds()->at((*id)[0]) : nullptr;
+    if (!world) {
+        reply(event);
+        return;
+    }
 
-    if (args.front() == on_select_menu1) {
-        t = personality::type{std::stoi(event.values[0])};
-    } else if (args.front() == on_select_menu2) {
-        t = personality::type{std::stoi(args[1])};
-        if (!lucy_->alert_manager()->set_custom_msg_for_alert(t, std::stoi(event.values[0]))) {
-            event.reply(dpp::message{"Something went wrong setting the message"}.set_flags(dpp::m_ephemeral));
+    const auto value = select_value(event);
+    if (!value) {
+        logger->warn("Malformed select value for alert id \"{}\"", event.custom_id);
+        reply(event);
+        return;
+    }
+
+    personality::type t;
+    const uint8_t kind = (*id)[1];
+
+    if (kind == main_menu) {
+        t = personality::type{*value};
+    } else if (kind == cmsg_menu) {
+        t = personality::type{(*id)[2]};
+        if (!world->alert_manager()->set_custom_msg_for_alert(t, *value)) {
+            reply(event, dpp::message{"Something went wrong setting the message"}.set_flags(dpp::m_ephemeral));
             return;
         }
         logger->info("User {} set message id={} for ptype={}", event.command.usr.global_name, event.values[0], t.t);
-    } else if (args.front() == on_select_menu3) {
-        t = personality::type{std::stoi(args[1])};
-        if (!lucy_->alert_manager()->set_custom_msg_for_horizon(t, std::stoi(event.values[0]))) {
-            event.reply(dpp::message{"Something went wrong setting the message"}.set_flags(dpp::m_ephemeral));
+    } else if (kind == hmsg_menu) {
+        t = personality::type{(*id)[2]};
+        if (!world->alert_manager()->set_custom_msg_for_horizon(t, *value)) {
+            reply(event, dpp::message{"Something went wrong setting the message"}.set_flags(dpp::m_ephemeral));
             return;
         }
         logger->info("User {} set horizon message id={} for ptype={}", event.command.usr.global_name, event.values[0],
                      t.t);
     }
 
-    event.reply(dpp::ir_update_message, build_button_menu_msg(t));
+    reply(event, dpp::ir_update_message, *menu(world, button_menu, t));
 }
 
 void Alert_on::handle_form_submit(const dpp::form_submit_t& event) {
-    auto args = extract_args(event.custom_id);
-    if (args.front() == on_custom_msg) {
+    auto id = decode_alert_id(event.custom_id);
+    World* world = id && id->action == Alert_Action::form_submit && (*id)[1] == custom_msg_form
+                       ? lucy_->worlds()->at((*id)[0])
+                       : nullptr;
+    if (world) {
         const std::string& title = std::get<std::string>(event.components[0].components[0].value);
         const std::string& msg = std::get<std::string>(event.components[1].components[0].value);
         if (title.empty() || msg.empty()) {
-            event.reply(dpp::ir_channel_message_with_source,
-                        dpp::message{"Fields title or message can't be empty"}
-                            .set_flags(dpp::m_ephemeral)
-                            .set_channel_id(event.command.channel_id));
+            reply(event, dpp::ir_channel_message_with_source,
+                  dpp::message{"Fields title or message can't be empty"}
+                      .set_flags(dpp::m_ephemeral)
+                      .set_channel_id(event.command.channel_id));
             return;
         }
 
-        lucy_->alert_manager()->add_custom_message(title, msg);
+        world->alert_manager()->add_custom_message(title, msg);
         logger->info("User {} added message, title={}", event.command.usr.global_name, title);
-        event.reply(dpp::ir_channel_message_with_source, dpp::message{"Message added"}.set_flags(dpp::m_ephemeral));
-    } else if (args.front() == on_horizon_msg) {
-
-        event.reply("horizon");
+        reply(event, dpp::ir_channel_message_with_source, dpp::message{"Message added"}.set_flags(dpp::m_ephemeral));
+        return;
     }
+
+    reply(event);
 }
 
 std::optional<std::string> Alert_on::handler_prefix() { return {prefix_alert_on}; }
 
-dpp::message Alert_on::build_button_menu_msg(personality::type t) {
+Menu_Cache::Menu Alert_on::menu(World* world, uint8_t kind, personality::type t) {
+    Menu_Cache& menus = menus_[world_field(world, lucy_)];
+    const uint64_t version = world->alert_manager()->config_version();
+    const uint32_t key = static_cast<uint32_t>(kind) << 8 | t.t;
+
+    if (kind == button_menu) {   // the embed shows the time left, render it again after a while
+        return menus.get(
+            key, version, [this, world, t]() { return build_button_menu_msg(world, t); }, s_button_menu_max_age);
+    }
+
+    return menus.get(key, version, [this, world, kind, t]() {
+        return kind == main_menu ? build_select_menu_message(lucy_, world)
+                                 : build_custom_message_menu(lucy_, world, t, static_cast<Alert_Menu>(kind));
+    });
+}
 
-    dpp::message m = lucy_->alert_manager()->build_alert_message(
-        lucy_->gamedata()->get_rnd_personality(t), system_clock::now() + minutes{5},
-        lucy_->alert_manager()->get_alert_message(t), 5);
+dpp::message Alert_on::build_button_menu_msg(World* world, personality::type t) {
+    Alert_Manager* alert_manager = world->alert_manager();
+    dpp::message m = alert_manager->build_alert_message(world_data(lucy_, world)->get_rnd_personality(t),
+                                                        system_clock::now() + minutes{5},
+                                                        alert_manager->get_alert_message(t), 5);
     m.set_flags(dpp::m_ephemeral);
 
-    auto btns = build_personality_btns(lucy_, t);
+    auto btns = build_personality_btns(lucy_, world, t);
     dpp::component row;
 
     int btn_count = 0;
@@ -385,7 +468,7 @@ dpp::message Alert_on::build_button_menu_msg(personality::type t) {
         m.add_component(row);
     }
 
-    m.embeds.front().set_color(lucy_->alert_manager()->is_alert_enabled(t) ? 0x00fd00 : 0xfd0000);
+    m.embeds.front().set_color(alert_manager->is_alert_enabled(t) ? 0x00fd00 : 0xfd0000);
     return m;
 }
 
@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <charconv>
 #include <mutex>
 #include <vector>
 
@@ -9,72 +10,93 @@
 #include "logger.h"
 #include "lucy.h"
 #include "personality.h"
+#include "util.h"
 
 namespace railcord::cmd {
 
-Command_handler::Command_handler(Lucy* lucy) : lucy_(lucy) {}
-
-Command_handler::~Command_handler() {
-    for (auto&& c : cmds_) {
-        delete c;
-    }
+static Counter& rejected(std::string_view reason) {
+    return metrics.counter("lucy_commands_rejected_total", "Interactions turned away", {{"reason", reason}});
 }
 
-static bool can_use_command(const dpp::slashcommand_t& event, Lucy* lucy) {
-    if (event.command.get_command_name() == "license") {   // temporary
-        return true;
-    }
+// Completion callback of a deferral, releases the edits waiting for it
+static dpp::command_completion_event_t acknowledged(std::shared_ptr<Pending_Reply> reply) {
+    return [reply = std::move(reply)](const dpp::confirmation_callback_t& cc) {
+        if (cc.is_error()) {
+            logger->warn("Deferring an interaction failed: {}", cc.get_error().message);
+        }
+        reply->acknowledge();
+    };
+}
 
-    const auto& whitelist = lucy->user_whitelist();
-    const auto& member = event.command.member;
+Command_handler::Command_handler(Lucy* lucy)
+    : lucy_(lucy), rejected_busy_(rejected("busy")), rejected_cooldown_(rejected("cooldown")) {
+    metrics.gauge_fn(
+        "lucy_interaction_queue", "Interactions waiting for a pool thread", {},
+        [this]() { return static_cast<double>(pool_.queued()); }, this);
+}
 
-    auto found = std::find(whitelist.cbegin(), whitelist.cend(), member.user_id);
-    if (found != whitelist.end()) {
-        return true;
+Command_handler::~Command_handler() {
+    metrics.remove(this);
+    if (housekeeping_timer_) {
+        lucy_->bot.stop_timer(housekeeping_timer_);
     }
+    pool_.stop();   // no handler may run past the commands
 
-    found = std::find(member.get_roles().cbegin(), member.get_roles().cend(), lucy->bot_admin_role());
-    if (found != member.get_roles().end()) {
-        return true;
+    for (auto&& c : cmds_) {
+        delete c;
     }
-
-    return false;
 }
 
 void Command_handler::on_slash_cmd() {
+    housekeeping_timer_ = lucy_->bot.start_timer([this](dpp::timer) { housekeeping(); }, s_housekeeping_interval);
+
     lucy_->bot.on_slashcommand([this](const dpp::slashcommand_t& event) {
-        if (!can_use_command(event, lucy_)) {
+        if (!lucy_->permissions()->can_use(event)) {
             event.reply(dpp::message{"You have no permissions for this command!"}.set_flags(dpp::m_ephemeral));
             return;
         }
 
         const std::string& command_name = event.command.get_command_name();
 
-        auto cmd = std::find_if(cmds_.begin(), cmds_.end(), [&](auto& c) { return c->name() == command_name; });
+        Base_Cmd* cmd = find_command(command_name);
 
-        if (cmd == cmds_.end()) {
+        if (!cmd) {
             logger->warn("Command {} not found", command_name);
             event.reply();
             return;
         }
 
-        if ((*cmd)->is_on_cooldown()) {
-            event.reply("Command is on cooldown");
-            return;
+        auto limiter = limiters_.find(cmd);
+        if (limiter != limiters_.end()) {
+            auto wait = limiter->second.acquire(event.command.usr.id);
+            if (wait.count() > 0) {
+                rejected_cooldown_.inc();
+                event.reply(dpp::message{fmt::format("Command is on cooldown, try again in {}s",
+                                                     std::chrono::ceil<std::chrono::seconds>(wait).count())}
+                                .set_flags(dpp::m_ephemeral));
+                return;
+            }
         }
 
-        (*cmd)->update_last_run_time();
-        (*cmd)->handle_slash_interaction(event);
+        run(
+            cmd, event, [cmd, event]() { cmd->handle_slash_interaction(event); },
+            [cmd, event](const std::shared_ptr<Pending_Reply>& reply) {
+                event.thinking(cmd->replies_ephemeral(), acknowledged(reply));
+            },
+            Pending_Reply::deferred);
     });
 }
 
 void Command_handler::on_form_submit() {
     lucy_->bot.on_form_submit([this](const dpp::form_submit_t& event) {
-        for (const auto& [prefix, cmd] : cmd_prefix_handlers_) {
-            if (event.custom_id.rfind(prefix, 0) == 0) {
-                cmd->handle_form_submit(event);
-                return;
-            }
+        if (Base_Cmd* cmd = route(event.custom_id)) {
+            run(
+                cmd, event, [cmd, event]() { cmd->handle_form_submit(event); },
+                [cmd, event](const std::shared_ptr<Pending_Reply>& reply) {
+                    event.thinking(cmd->replies_ephemeral(), acknowledged(reply));
+                },
+                Pending_Reply::deferred);
+            return;
         }
 
         logger->warn("on_form_submit id \"{}\" does not have a handler", event.custom_id);
@@ -84,11 +106,14 @@ void Command_handler::on_form_submit() {
 
 void Command_handler::on_button_click() {
     lucy_->bot.on_button_click([this](const dpp::button_click_t& event) {
-        for (const auto& [prefix, cmd] : cmd_prefix_handlers_) {
-            if (event.custom_id.rfind(prefix, 0) == 0) {
-                cmd->handle_button_click(event);
-                return;
-            }
+        if (Base_Cmd* cmd = route(event.custom_id)) {
+            run(
+                cmd, event, [cmd, event]() { cmd->handle_button_click(event); },
+                [event](const std::shared_ptr<Pending_Reply>& reply) {
+                    event.reply(dpp::ir_deferred_update_message, dpp::message{}, acknowledged(reply));
+                },
+                Pending_Reply::deferred_update);
+            return;
         }
 
         logger->warn("on_button_click id \"{}\" does not have a handler", event.custom_id);
@@ -98,11 +123,14 @@ void Command_handler::on_button_click() {
 
 void Command_handler::on_select_click() {
     lucy_->bot.on_select_click([this](const dpp::select_click_t& event) {
-        for (const auto& [prefix, cmd] : cmd_prefix_handlers_) {
-            if (event.custom_id.rfind(prefix, 0) == 0) {
-                cmd->handle_select_click(event);
-                return;
-            }
+        if (Base_Cmd* cmd = route(event.custom_id)) {
+            run(
+                cmd, event, [cmd, event]() { cmd->handle_select_click(event); },
+                [event](const std::shared_ptr<Pending_Reply>& reply) {
+                    event.reply(dpp::ir_deferred_update_message, dpp::message{}, acknowledged(reply));
+                },
+                Pending_Reply::deferred_update);
+            return;
         }
 
         logger->warn("on_select_click id \"{}\" does not have a handler", event.custom_id);
@@ -110,14 +138,110 @@ void Command_handler::on_select_click() {
     });
 }
 
+static std::string_view trim(std::string_view s) {
+    while (!s.empty() && s.front() == ' ') {
+        s.remove_prefix(1);
+    }
+    while (!s.empty() && s.back() == ' ') {
+        s.remove_suffix(1);
+    }
+    return s;
+}
+
+void Command_handler::set_rate_limits(std::string_view spec) {
+    util::for_each_entry(spec, [this](std::string_view entry) {
+        auto colon = entry.find(':');
+        auto slash = entry.find('/', colon);
+        if (colon == std::string_view::npos || slash == std::string_view::npos) {
+            logger->warn("Ignoring rate limit \"{}\", expected name:burst/seconds", entry);
+            return;
+        }
+
+        std::string_view name = trim(entry.substr(0, colon));
+        std::string_view burst = trim(entry.substr(colon + 1, slash - colon - 1));
+        std::string_view seconds = trim(entry.substr(slash + 1));
+        Rate_Limit limit;
+        unsigned refill{};
+        if (name.empty() ||
+            std::from_chars(burst.data(), burst.data() + burst.size(), limit.burst).ec != std::errc{} ||
+            std::from_chars(seconds.data(), seconds.data() + seconds.size(), refill).ec != std::errc{}) {
+            logger->warn("Ignoring rate limit \"{}\", expected name:burst/seconds", entry);
+            return;
+        }
+
+        limit.refill = std::chrono::seconds{refill};
+        rate_limits_[std::string{name}] = limit;
+    });
+}
+
 void Command_handler::add_command(Base_Cmd* cmd) {
     if (std::find(cmds_.begin(), cmds_.end(), cmd) == cmds_.end()) {
         cmds_.push_back(cmd);
+        cmd_by_name_.emplace(cmd->name(), cmd);
+
+        auto limit = rate_limits_.find(cmd->name());
+        Rate_Limit rl = limit != rate_limits_.end() ? limit->second : Rate_Limit{1, cmd->cooldown()};
+        limiters_.try_emplace(cmd, rl);
+        latencies_.try_emplace(cmd, &metrics.histogram("lucy_command_seconds",
+                                                       "Time from the interaction to the return of its handler",
+                                                       {{"command", cmd->name()}}));
+        logger->debug("Rate limit {}: burst {} every {}ms", cmd->name(), rl.burst, rl.refill.count());
 
         const auto& cmd_prefix = cmd->handler_prefix();
         if (cmd_prefix) {
             logger->debug("Adding prefix handler {}:{}", *cmd_prefix, cmd->name());
-            cmd_prefix_handlers_.emplace_back(*cmd_prefix, cmd);
+            cmd_by_prefix_.emplace(prefixes_.emplace_back(*cmd_prefix), cmd);
+        }
+    }
+}
+
+Base_Cmd* Command_handler::find_command(std::string_view name) const {
+    auto found = cmd_by_name_.find(name);
+    return found != cmd_by_name_.end() ? found->second : nullptr;
+}
+
+Base_Cmd* Command_handler::route(std::string_view custom_id) const {
+    auto sep = custom_id.find(handler_prefix_sep);
+    if (sep == std::string_view::npos) {
+        return nullptr;
+    }
+
+    auto found = cmd_by_prefix_.find(custom_id.substr(0, sep));
+    return found != cmd_by_prefix_.end() ? found->second : nullptr;
+}
+
+void Command_handler::run(Base_Cmd* cmd, const dpp::interaction_create_t& event, std::function<void()> handler,
+                          Pending_Reply::Defer defer, Pending_Reply::State defer_as) {
+    const auto received = std::chrono::steady_clock::now();
+    Histogram* latency = latencies_.at(cmd);
+
+    bool queued = pool_.submit(
+        [handler = std::move(handler), latency, received]() {
+            handler();
+            latency->record(std::chrono::steady_clock::now() - received);
+        },
+        std::move(defer), defer_as, s_reply_budget);
+
+    if (!queued) {
+        logger->warn("Interaction pool is full, rejecting {}", cmd->name());
+        rejected_busy_.inc();
+        event.reply(dpp::message{"Lucy is busy, try again in a moment"}.set_flags(dpp::m_ephemeral));
+    }
+}
+
+void Command_handler::housekeeping() {
+    size_t evicted = 0;
+    for (auto& [cmd, limiter] : limiters_) {
+        evicted += limiter.evict_idle();
+    }
+
+    if (evicted) {
+        logger->debug("Evicted {} idle cooldowns", evicted);
+    }
+
+    for (const auto& [cmd, latency] : latencies_) {
+        if (latency->count()) {
+            logger->info("Latency {}: {}", cmd->name(), latency->summary());
         }
     }
 }
@@ -134,6 +258,15 @@ void Command_handler::load_all_commands() {
         add_command(new cmd::Save_Settings(lucy_));
         add_command(new cmd::Remove_Custom_Message(lucy_));
         add_command(new cmd::License_Bid(lucy_));
+        add_command(new cmd::Subscribe(lucy_));
+        add_command(new cmd::Reload_Permissions(lucy_));
+        add_command(new cmd::Stats(lucy_));
+
+        for (const auto& limit : rate_limits_) {
+            if (!cmd_by_name_.count(limit.first)) {
+                logger->warn("Rate limit for unknown command \"{}\" is not used", limit.first);
+            }
+        }
     });
 }
 
@@ -166,4 +299,96 @@ void Command_handler::deregister_commands() {
         }
     });
 }
+/// ---------------------------------------- Base_Cmd ---------------------------------------
+#pragma region Base_Cmd
+
+// Claims the reply of the running handler. pending when the handler answers first, otherwise what was sent already
+static Pending_Reply::State claim_reply() {
+    Pending_Reply* pending = Pending_Reply::current;
+    if (!pending || pending->claim(Pending_Reply::replied)) {
+        return Pending_Reply::pending;
+    }
+    return static_cast<Pending_Reply::State>(pending->state.load());
+}
+
+void Base_Cmd::reply(const dpp::interaction_create_t& event) const {
+    if (claim_reply() == Pending_Reply::pending) {
+        event.reply();
+    }
+}
+
+void Base_Cmd::reply(const dpp::interaction_create_t& event, const std::string& content) const {
+    reply(event, dpp::message{content});
+}
+
+void Base_Cmd::reply(const dpp::interaction_create_t& event, const dpp::message& m,
+                     dpp::command_completion_event_t callback) const {
+    reply(event, dpp::ir_channel_message_with_source, m, std::move(callback));
+}
+
+void Base_Cmd::reply(const dpp::interaction_create_t& event, dpp::interaction_response_type type,
+                     const dpp::message& m, dpp::command_completion_event_t callback) const {
+    const Pending_Reply::State state = claim_reply();
+    if (state == Pending_Reply::pending) {
+        event.reply(type, m, std::move(callback));
+        return;
+    }
+
+    Pending_Reply* pending = Pending_Reply::current;
+    if (state == Pending_Reply::deferred ||
+        (state == Pending_Reply::deferred_update && type == dpp::ir_update_message)) {
+        pending->after_ack([event, m, callback]() { event.edit_original_response(m, callback); });
+    } else if (state == Pending_Reply::deferred_update) {
+        // the original response is the component's message, anything else is a new one
+        pending->after_ack([bot = &lucy_->bot, token = event.command.token, m, callback]() {
+            bot->interaction_followup_create(token, m, callback);
+        });
+    } else {
+        logger->warn("{}: the interaction was replied to already, dropping the second reply", name_);
+    }
+}
+
+void Base_Cmd::defer(const dpp::interaction_create_t& event, bool ephemeral) const {
+    Pending_Reply* pending = Pending_Reply::current;
+    if (!pending) {
+        event.thinking(ephemeral);
+    } else if (pending->claim(Pending_Reply::deferred)) {
+        event.thinking(ephemeral, acknowledged(pending->shared_from_this()));
+    }
+}
+
+void Base_Cmd::dialog(const dpp::interaction_create_t& event, const dpp::interaction_modal_response& modal) const {
+    const Pending_Reply::State state = claim_reply();
+    if (state == Pending_Reply::pending) {
+        event.dialog(modal);
+        return;
+    }
+    if (state == Pending_Reply::replied) {
+        logger->warn("{}: the interaction was replied to already, dropping the modal", name_);
+        return;
+    }
+
+    logger->warn("{}: deferred before the modal could be opened", name_);
+    const auto m = dpp::message{"That took too long, please try again"}.set_flags(dpp::m_ephemeral);
+    Pending_Reply::current->after_ack([bot = &lucy_->bot, token = event.command.token, m]() {
+        bot->interaction_followup_create(token, m);
+    });
+}
+
+std::optional<int> Base_Cmd::select_value(const dpp::select_click_t& event) {
+    if (event.values.empty()) {
+        return {};
+    }
+
+    const std::string& value = event.values.front();
+    int n{};
+    auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), n);
+    if (ec != std::errc{} || end != value.data() + value.size()) {
+        return {};
+    }
+    return n;
+}
+
+#pragma endregion Base_Cmd
+
 }   // namespace railcord::cmd
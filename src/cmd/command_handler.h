@@ -1,14 +1,28 @@
 #ifndef COMMAND_HANDLER_H
 #define COMMAND_HANDLER_H
 
+#include <chrono>
+#include <deque>
+#include <functional>
 #include <string>
-#include <utility>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
+#include <dpp/timer.h>
+
+#include "interaction_pool.h"
+#include "metrics.h"
+#include "rate_limiter.h"
+
 namespace railcord {
 class Lucy;
 }
 
+namespace dpp {
+struct interaction_create_t;
+}
+
 namespace railcord::cmd {
 
 class Base_Cmd;
@@ -26,15 +40,43 @@ class Command_handler {
     void on_button_click();
     void on_select_click();
 
+    // "name:burst/seconds" entries separated by commas, applied to the commands added after
+    void set_rate_limits(std::string_view spec);
+
     void add_command(Base_Cmd* cmd);
     void load_all_commands();
     void register_commands();
     void deregister_commands();
 
   private:
+    Base_Cmd* find_command(std::string_view name) const;
+    Base_Cmd* route(std::string_view custom_id) const;   // by the prefix of a Custom_Id custom id
+    void housekeeping();   // evicts idle cooldowns and logs the latencies
+
+    // Runs handler on pool_, defer is sent if it has not replied within s_reply_budget
+    void run(Base_Cmd* cmd, const dpp::interaction_create_t& event, std::function<void()> handler,
+             Pending_Reply::Defer defer, Pending_Reply::State defer_as);
+
     Lucy* lucy_;
     std::vector<Base_Cmd*> cmds_;
-    std::vector<std::pair<std::string, Base_Cmd*>> cmd_prefix_handlers_;   // prefix -> cmd
+
+    // built once in add_command, the keys are views into the command names and prefixes_
+    std::unordered_map<std::string_view, Base_Cmd*> cmd_by_name_;
+    std::deque<std::string> prefixes_;
+    std::unordered_map<std::string_view, Base_Cmd*> cmd_by_prefix_;
+
+    // per user cooldowns, one limiter for each command, the command cooldown with a burst of 1 by default
+    std::unordered_map<std::string, Rate_Limit> rate_limits_;
+    std::unordered_map<const Base_Cmd*, Rate_Limiter> limiters_;
+    std::unordered_map<const Base_Cmd*, Histogram*> latencies_;   // from the event to the handler return, in metrics
+    Counter& rejected_busy_;
+    Counter& rejected_cooldown_;
+    dpp::timer housekeeping_timer_{};
+
+    Interaction_Pool pool_;
+
+    static constexpr uint64_t s_housekeeping_interval = 600;            // seconds
+    static constexpr std::chrono::milliseconds s_reply_budget{2000};   // Discord drops replies after 3s
 };
 
 }   // namespace railcord::cmd
@@ -2,6 +2,7 @@
 #define COMMANDS_H
 
 #include <chrono>
+#include <deque>
 #include <mutex>
 #include <optional>
 #include <string>
@@ -10,18 +11,19 @@
 
 #include <dpp/dpp.h>
 
+#include "autocomplete_index.h"
+#include "custom_id.h"
 #include "license.h"
+#include "menu_cache.h"
 #include "personality.h"
 
 namespace railcord {
 class Lucy;
+class World;
 }
 
 namespace railcord::cmd {
 
-inline constexpr const char* handler_prefix_sep = ":";
-inline constexpr const char* handler_arg_sep = "-";
-
 class Base_Cmd {
   public:
     Base_Cmd() = default;
@@ -38,21 +40,33 @@ class Base_Cmd {
     virtual void handle_form_submit(const dpp::form_submit_t&) {}
 
     virtual std::optional<std::string> handler_prefix() { return {}; }
+    // Visibility of the thinking response when the pool defers a slash command or form, like the handler's replies
+    virtual bool replies_ephemeral() { return true; }
 
     const std::string& name() { return name_; }
     const std::string& description() { return description_; }
-    const std::chrono::seconds cooldown() { return cooldown_; }
-
-    bool is_on_cooldown() { return std::chrono::system_clock::now() < last_run_ + cooldown_; }
-    void update_last_run_time() { last_run_ = std::chrono::system_clock::now(); }
+    const std::chrono::seconds cooldown() { return cooldown_; }   // per user, see Command_handler
 
   protected:
     Base_Cmd(std::string n, std::string d, std::chrono::duration<long> c, Lucy* lucy)
         : name_(std::move(n)), description_(std::move(d)), cooldown_(c), lucy_(lucy) {}
+
+    // Handlers run on Command_handler's pool, which defers slow ones. Once deferred these edit the original response
+    // after Discord acknowledged the deferral, a component's deferred update is only edited by ir_update_message and
+    // other replies become follow-up messages. A second reply is dropped
+    void reply(const dpp::interaction_create_t& event) const;   // acknowledge only
+    void reply(const dpp::interaction_create_t& event, const std::string& content) const;
+    void reply(const dpp::interaction_create_t& event, const dpp::message& m,
+               dpp::command_completion_event_t callback = dpp::utility::log_error()) const;
+    void reply(const dpp::interaction_create_t& event, dpp::interaction_response_type type, const dpp::message& m,
+               dpp::command_completion_event_t callback = dpp::utility::log_error()) const;
+    void defer(const dpp::interaction_create_t& event, bool ephemeral = false) const;   // thinking, if not yet deferred
+    // A modal can only be the first response, once deferred the user is told to try again
+    void dialog(const dpp::interaction_create_t& event, const dpp::interaction_modal_response& modal) const;
+    static std::optional<int> select_value(const dpp::select_click_t& event);   // empty if not a number
     std::string name_;
     std::string description_;
     std::chrono::seconds cooldown_;
-    std::chrono::system_clock::time_point last_run_;
     Lucy* lucy_;
 };
 
@@ -62,6 +76,7 @@ class Ping : public Base_Cmd {
 
     dpp::slashcommand build() override;
     void handle_slash_interaction(const dpp::slashcommand_t& event) override;
+    bool replies_ephemeral() override { return false; }
 };
 
 class Shutdown : public Base_Cmd {
@@ -70,8 +85,14 @@ class Shutdown : public Base_Cmd {
 
     dpp::slashcommand build() override;
     void handle_slash_interaction(const dpp::slashcommand_t& event) override;
+    bool replies_ephemeral() override { return false; }
 };
 
+// The world option of the commands acting on one gameworld, only added when more than the main world is configured
+dpp::slashcommand add_world_option(dpp::slashcommand cmd, Lucy* lucy);
+World* selected_world(const dpp::slashcommand_t& event, Lucy* lucy);   // the main one if not given, null if unknown
+uint8_t world_field(const World* world, Lucy* lucy);   // the world in a Custom_Id, read back with World_Set::at
+
 class Watch : public Base_Cmd {
   public:
     Watch(Lucy* lucy);
@@ -108,7 +129,12 @@ class Alert_on : public Base_Cmd {
     std::optional<std::string> handler_prefix() override;
 
   private:
-    dpp::message build_button_menu_msg(personality::type t);
+    dpp::message build_button_menu_msg(World* world, personality::type t);
+    // rendered once per alert config version of the world
+    Menu_Cache::Menu menu(World* world, uint8_t kind, personality::type t = {});
+
+    std::deque<Menu_Cache> menus_;   // one per world, by its World_Set index
+    static constexpr std::chrono::seconds s_button_menu_max_age{60};
 };
 
 class Save_Settings : public Base_Cmd {
@@ -127,6 +153,35 @@ class Remove_Custom_Message : public Base_Cmd {
     void handle_slash_interaction(const dpp::slashcommand_t& event) override;
     void handle_select_click(const dpp::select_click_t&) override;
     std::optional<std::string> handler_prefix() override;
+
+  private:
+    Menu_Cache::Menu menu(World* world);
+
+    std::deque<Menu_Cache> menus_;   // one per world, by its World_Set index
+};
+
+class Reload_Permissions : public Base_Cmd {
+  public:
+    Reload_Permissions(Lucy* lucy);
+
+    dpp::slashcommand build() override;
+    void handle_slash_interaction(const dpp::slashcommand_t& event) override;
+};
+
+class Stats : public Base_Cmd {
+  public:
+    Stats(Lucy* lucy);
+
+    dpp::slashcommand build() override;
+    void handle_slash_interaction(const dpp::slashcommand_t& event) override;
+};
+
+class Subscribe : public Base_Cmd {
+  public:
+    Subscribe(Lucy* lucy);
+
+    dpp::slashcommand build() override;
+    void handle_slash_interaction(const dpp::slashcommand_t& event) override;
 };
 
 class License_Bid : public Base_Cmd {
@@ -136,49 +191,17 @@ class License_Bid : public Base_Cmd {
     dpp::slashcommand build() override;
     void handle_slash_interaction(const dpp::slashcommand_t& event) override;
     std::optional<std::string> handler_prefix() override;
-
-    std::vector<dpp::snowflake> users_to_remind(const std::string& id);
-    void remove_reminder(const std::string& id);
+    bool replies_ephemeral() override { return false; }
 
   private:
     void add_reminder(const License& license, const dpp::slashcommand_t& event);
-    bool has_license_reminder(const std::string& id, dpp::snowflake user);
-    bool has_active_reminder(const std::string& id);
-
-    std::mutex mtx_;
-    std::chrono::system_clock::time_point last_update_;
-    License_Manager license_manager_;
+    void send_reminder(const License_Reminders::Reminder& reminder);
 
-    std::unordered_map<std::string, std::vector<dpp::snowflake>> license_reminders_;
-    std::unordered_map<std::string, dpp::timer> active_timers_;
+    License_Manager license_manager_;   // refreshed in the background
+    License_Reminders reminders_;
+    Autocomplete_Index goods_index_;
 };
 
-template <typename Arg1, typename Arg2, typename... Params>
-std::string build_id(Arg1 prefix, Arg2 handler, Params&&... params) {
-    std::string id{prefix};
-    id.append(handler_prefix_sep);
-    id.append(handler);
-    if constexpr (sizeof...(Params) != 0) {
-        (id.append(handler_arg_sep).append(std::forward<Params>(params)), ...);
-    }
-    return id;
-}
-
-inline std::vector<std::string> extract_args(const std::string& id) {
-    std::vector<std::string> args;
-    auto arg = id.find(handler_arg_sep);
-    while (arg != std::string::npos && arg + 1 < id.size()) {
-        auto end = id.find(handler_arg_sep, arg + 1);
-        std::string&& str = end != std::string::npos ? id.substr(arg + 1, end - (arg + 1)) : id.substr(arg + 1);
-        if (!str.empty()) {
-            args.push_back(std::move(str));
-        }
-        arg = end;
-    }
-
-    return args;
-}
-
 }   // namespace railcord::cmd
 
 #endif   // !COMMANDS_H
@@ -0,0 +1,100 @@
+#ifndef CUSTOM_ID_H
+#define CUSTOM_ID_H
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace railcord::cmd {
+
+inline constexpr const char* handler_prefix_sep = ":";
+
+// Component ids of the form "<prefix>:<action><field>...", a one char action tag followed by fixed width hex
+// bytes. Short ids stay within the small string buffer and decoding only reads the view
+template <typename Action>
+struct Custom_Id {
+    static_assert(std::is_enum_v<Action> && sizeof(Action) == 1, "actions are one char tags");
+
+    static constexpr size_t s_max_fields = 8;
+    static constexpr size_t s_field_width = 2;
+
+    Action action{};
+    uint8_t field_count{};
+    std::array<uint8_t, s_max_fields> fields{};
+
+    uint8_t operator[](size_t i) const {
+        assert(i < field_count);
+        return fields[i];
+    }
+
+    template <typename... Fields>
+    static std::string encode(std::string_view prefix, Action action, Fields... values) {
+        static_assert(sizeof...(Fields) <= s_max_fields, "too many fields");
+        static_assert(((std::is_integral_v<Fields> || std::is_enum_v<Fields>) && ...), "fields are small integers");
+        constexpr char digits[] = "0123456789abcdef";
+
+        std::array<char, 64> buf{};
+        size_t size = 0;
+        assert(prefix.size() + 2 + sizeof...(Fields) * s_field_width <= buf.size());
+        for (char c : prefix) {
+            buf[size++] = c;
+        }
+        buf[size++] = *handler_prefix_sep;
+        buf[size++] = static_cast<char>(action);
+
+        const auto put = [&](auto value) {
+            const int v = static_cast<int>(value);
+            assert(v >= 0 && v <= 0xFF && "field out of range");
+            const auto byte = static_cast<uint8_t>(v);
+            buf[size++] = digits[byte >> 4];
+            buf[size++] = digits[byte & 0xF];
+        };
+        (put(values), ...);
+
+        return std::string(buf.data(), size);
+    }
+
+    // Empty if the id is malformed or has another prefix, the fields are not checked against the action
+    static std::optional<Custom_Id> decode(std::string_view id, std::string_view prefix) {
+        const size_t header = prefix.size() + 2;
+        if (id.size() < header || id.substr(0, prefix.size()) != prefix || id[prefix.size()] != *handler_prefix_sep) {
+            return {};
+        }
+
+        const std::string_view body = id.substr(header);
+        if (body.size() % s_field_width != 0 || body.size() / s_field_width > s_max_fields) {
+            return {};
+        }
+
+        Custom_Id parsed;
+        parsed.action = static_cast<Action>(id[header - 1]);
+        for (size_t i = 0; i < body.size(); i += s_field_width) {
+            const int high = hex_value(body[i]);
+            const int low = hex_value(body[i + 1]);
+            if (high < 0 || low < 0) {
+                return {};
+            }
+            parsed.fields[parsed.field_count++] = static_cast<uint8_t>(high << 4 | low);
+        }
+        return parsed;
+    }
+
+  private:
+    static constexpr int hex_value(char c) {
+        if (c >= '0' && c <= '9') {
+            return c - '0';
+        }
+        if (c >= 'a' && c <= 'f') {
+            return c - 'a' + 10;
+        }
+        return -1;
+    }
+};
+
+}   // namespace railcord::cmd
+
+#endif   // !CUSTOM_ID_H
@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <exception>
+
+#include "interaction_pool.h"
+#include "logger.h"
+
+namespace railcord::cmd {
+using namespace std::chrono;
+
+thread_local Pending_Reply* Pending_Reply::current = nullptr;
+
+/// ---------------------------------------- Pending_Reply ---------------------------------------
+#pragma region Pending_Reply
+
+void Pending_Reply::after_ack(std::function<void()> fn) {
+    {
+        std::lock_guard<std::mutex> lock{mtx_};
+        if (!acked_) {
+            waiting_.push_back(std::move(fn));
+            return;
+        }
+    }
+    fn();
+}
+
+void Pending_Reply::acknowledge() {
+    std::vector<std::function<void()>> ready;
+    {
+        std::lock_guard<std::mutex> lock{mtx_};
+        acked_ = true;
+        ready.swap(waiting_);
+    }
+    for (auto& fn : ready) {
+        fn();
+    }
+}
+
+#pragma endregion Pending_Reply
+
+/// ---------------------------------------- Interaction_Pool ---------------------------------------
+#pragma region Interaction_Pool
+
+Interaction_Pool::Interaction_Pool(size_t threads, size_t capacity) : capacity_(capacity) {
+    threads = std::max<size_t>(threads, 1);
+    for (size_t i = 0; i < threads; ++i) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    for (size_t i = 0; i < threads; ++i) {
+        workers_.emplace_back(&Interaction_Pool::work, this, i);
+    }
+    watchdog_ = std::thread{&Interaction_Pool::watch, this};
+}
+
+Interaction_Pool::~Interaction_Pool() { stop(); }
+
+bool Interaction_Pool::submit(Task task, Pending_Reply::Defer defer, Pending_Reply::State defer_as,
+                              milliseconds budget) {
+    if (queued_.fetch_add(1) >= capacity_) {
+        queued_.fetch_sub(1);
+        return false;
+    }
+
+    auto reply = std::make_shared<Pending_Reply>();
+    reply->defer = std::move(defer);
+    reply->defer_as = defer_as;
+
+    {
+        std::lock_guard<std::mutex> lock{mtx_};
+        if (stopping_) {
+            queued_.fetch_sub(1);
+            return false;
+        }
+        auto it = deadlines_.emplace(steady_clock::now() + budget, reply);
+        if (it == deadlines_.begin()) {
+            watch_cv_.notify_one();
+        }
+    }
+
+    Queue& q = *queues_[next_.fetch_add(1) % queues_.size()];
+    {
+        std::lock_guard<std::mutex> lock{q.mtx};
+        q.jobs.push_back(Job{std::move(task), std::move(reply)});
+    }
+
+    std::lock_guard<std::mutex> lock{mtx_};
+    work_cv_.notify_one();
+    return true;
+}
+
+void Interaction_Pool::stop() {
+    {
+        std::lock_guard<std::mutex> lock{mtx_};
+        if (stopping_) {
+            return;
+        }
+        stopping_ = true;
+    }
+    work_cv_.notify_all();
+    watch_cv_.notify_all();
+
+    for (auto& t : workers_) {
+        if (t.joinable()) {
+            t.join();
+        }
+    }
+    if (watchdog_.joinable()) {
+        watchdog_.join();
+    }
+}
+
+bool Interaction_Pool::pop(size_t self, Job& job) {
+    for (size_t i = 0; i < queues_.size(); ++i) {
+        Queue& q = *queues_[(self + i) % queues_.size()];
+        std::lock_guard<std::mutex> lock{q.mtx};
+        if (q.jobs.empty()) {
+            continue;
+        }
+
+        if (i == 0) {
+            job = std::move(q.jobs.front());
+            q.jobs.pop_front();
+        } else {
+            job = std::move(q.jobs.back());
+            q.jobs.pop_back();
+        }
+        queued_.fetch_sub(1);
+        return true;
+    }
+    return false;
+}
+
+void Interaction_Pool::work(size_t self) {
+    for (;;) {
+        Job job;
+        if (!pop(self, job)) {
+            std::unique_lock<std::mutex> lock{mtx_};
+            work_cv_.wait(lock, [this]() { return stopping_ || queued_.load() > 0; });
+            if (stopping_) {
+                return;
+            }
+            continue;
+        }
+
+        Pending_Reply::current = job.reply.get();
+        try {
+            job.task();
+        } catch (const std::exception& e) {
+            logger->error("Interaction handler threw: {}", e.what());
+        }
+        job.reply->claim(Pending_Reply::done);
+        Pending_Reply::current = nullptr;
+    }
+}
+
+void Interaction_Pool::watch() {
+    std::unique_lock<std::mutex> lock{mtx_};
+    while (!stopping_) {
+        if (deadlines_.empty()) {
+            watch_cv_.wait(lock);
+            continue;
+        }
+
+        const auto next = deadlines_.begin()->first;
+        if (steady_clock::now() < next) {
+            watch_cv_.wait_until(lock, next);
+            continue;
+        }
+
+        std::vector<std::shared_ptr<Pending_Reply>> late;
+        for (auto it = deadlines_.begin(); it != deadlines_.end() && it->first <= steady_clock::now();) {
+            if (auto reply = it->second.lock()) {
+                late.push_back(std::move(reply));
+            }
+            it = deadlines_.erase(it);
+        }
+
+        lock.unlock();
+        for (auto& reply : late) {
+            if (reply->claim(reply->defer_as)) {
+                reply->defer(reply);
+            }
+        }
+        lock.lock();
+    }
+}
+
+#pragma endregion Interaction_Pool
+
+}   // namespace railcord::cmd
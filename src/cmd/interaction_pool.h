@@ -0,0 +1,99 @@
+#ifndef INTERACTION_POOL_H
+#define INTERACTION_POOL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace railcord::cmd {
+
+// Reply state of an interaction handled on the pool, whichever of the handler and the watchdog claims it first wins.
+// deferred_update is the silent deferral of a component interaction, its original response is the component's message
+struct Pending_Reply : std::enable_shared_from_this<Pending_Reply> {
+    enum State : uint8_t { pending, replied, deferred, deferred_update, done };
+    using Defer = std::function<void(const std::shared_ptr<Pending_Reply>&)>;
+
+    bool claim(State to) {
+        uint8_t expected = pending;
+        return state.compare_exchange_strong(expected, to);
+    }
+
+    // Edits of the original response are separate webhook requests, Discord only knows the response once the
+    // deferral was acknowledged. fn runs then, or right away if it already was
+    void after_ack(std::function<void()> fn);
+    void acknowledge();   // from the completion callback of the deferral
+
+    std::atomic<uint8_t> state{pending};
+    State defer_as{deferred};   // set before the pool sees the reply
+    Defer defer;                // sends the deferred response, acknowledge() once it completed
+
+    static thread_local Pending_Reply* current;   // of the handler running on this thread, null off the pool
+
+  private:
+    std::mutex mtx_;
+    bool acked_{false};
+    std::vector<std::function<void()>> waiting_;
+};
+
+// Bounded pool running interaction handlers off the gateway threads. Each worker has its own queue and steals from
+// the others when it runs dry, a watchdog sends the deferred response of handlers past their latency budget
+class Interaction_Pool {
+  public:
+    using Task = std::function<void()>;
+
+    Interaction_Pool(size_t threads = s_default_threads, size_t capacity = s_default_capacity);
+    Interaction_Pool(const Interaction_Pool&) = delete;
+    Interaction_Pool& operator=(const Interaction_Pool&) = delete;
+    ~Interaction_Pool();
+
+    // False when capacity tasks are already queued. defer runs at most once, when task has not replied by budget, and
+    // leaves the reply in the defer_as state
+    bool submit(Task task, Pending_Reply::Defer defer, Pending_Reply::State defer_as, std::chrono::milliseconds budget);
+    void stop();   // joins the threads, tasks still queued are dropped
+    size_t queued() const { return queued_.load(std::memory_order_relaxed); }
+
+    static constexpr size_t s_default_threads = 4;
+    static constexpr size_t s_default_capacity = 64;
+
+  private:
+    struct Job {
+        Task task;
+        std::shared_ptr<Pending_Reply> reply;
+    };
+    struct Queue {
+        std::mutex mtx;
+        std::deque<Job> jobs;
+    };
+
+    void work(size_t self);
+    bool pop(size_t self, Job& job);   // own queue first, then steals from the back of the others
+    void watch();
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::atomic<size_t> queued_{0};
+    std::atomic<size_t> next_{0};
+    size_t capacity_;
+
+    std::mutex mtx_;   // stopping_, deadlines_ and the sleep of the threads
+    std::condition_variable work_cv_;
+    std::condition_variable watch_cv_;
+    bool stopping_{false};
+    std::multimap<std::chrono::steady_clock::time_point, std::weak_ptr<Pending_Reply>> deadlines_;
+
+    std::vector<std::thread> workers_;
+    std::thread watchdog_;
+};
+
+}   // namespace railcord::cmd
+
+#endif   // !INTERACTION_POOL_H
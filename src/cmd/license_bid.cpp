@@ -13,30 +13,22 @@ constexpr const char* prefix_license_bid = "license";
 constexpr const char* cmd_option_name = "good_name";
 
 License_Bid::License_Bid(Lucy* lucy)
-    : Base_Cmd("license", "Alert you when a license you want has an auction", seconds{3}, lucy) {
-
-    license_manager_.update_state();
-    last_update_ = system_clock::now();
-
-    std::vector<std::string> choices;
-    const auto& goods = lucy->gamedata()->goods();
-    auto begin = goods.begin() + 1;   // skip random good
-    auto end = goods.end();
-    while (begin != end) {
-        choices.emplace_back(begin->name);
-        ++begin;
-    }
+    : Base_Cmd("license", "Alert you when a license you want has an auction", seconds{3}, lucy),
+      reminders_(&lucy->bot) {
 
-    // std::sort(choices_.begin(), choices_.end()); // for now index + 1 = good id
+    license_manager_.start();
+    reminders_.start([this](const License_Reminders::Reminder& r) { send_reminder(r); });
 
-    std::vector<std::string> lowercase_choices;
-    for (const auto& c : choices) {
-        lowercase_choices.emplace_back(util::to_lowercase(c));
+    std::vector<Autocomplete_Index::Choice> choices;
+    auto data = lucy->gamedata()->snapshot();
+    const auto& goods = data->goods();
+    for (size_t i = 1; i < goods.size(); ++i) {   // skip random good, the good id is the index
+        choices.push_back({std::string{goods[i].name}, std::to_string(i)});
     }
+    goods_index_ = Autocomplete_Index{std::move(choices)};
 
-    lucy->bot.on_autocomplete([bot = &lucy->bot, cmd_name = name_, choices = std::move(choices),
-                               l_choices = std::move(lowercase_choices)](const dpp::autocomplete_t& event) {
-        if (event.name != cmd_name) {
+    lucy->bot.on_autocomplete([this](const dpp::autocomplete_t& event) {
+        if (event.name != name_) {
             return;
         }
 
@@ -46,32 +38,16 @@ License_Bid::License_Bid(Lucy* lucy)
                 continue;
             }
 
-            std::string uservalue = util::to_lowercase(std::get<std::string>(opt.value));
-            std::vector<int> autocomplete_choices;
-            int idx = 0;
-            int autocompleted = 0;
-            for (const auto& c : l_choices) {
-                if (util::starts_with(c, uservalue)) {
-                    autocomplete_choices.push_back(idx);
-                    ++autocompleted;
-                }
-                ++idx;
-                if (autocompleted == 25) {
-                    break;
-                }
-            }
-
-            dpp::interaction_response res{dpp::ir_autocomplete_reply};
-            for (int choice : autocomplete_choices) {
-                res.add_autocomplete_choice(dpp::command_option_choice(
-                    choices[static_cast<size_t>(choice)],
-                    std::to_string(choice + 1)));   // good id is offset by one, first good ignored
-            }
-
-            bot->interaction_response_create(event.command.id, event.command.token, res);
-            // logger->debug("Autocomplete {}  with value '{}' in field {} for user {}", opt.name, uservalue,
-            // event.name,
-            //               event.command.usr.global_name);
+            // the serialized reply is posted as is, interaction_response_create would rebuild it
+            lucy_->bot.post_rest(API_PATH "/interactions", std::to_string(event.command.id),
+                                 dpp::utility::url_encode(event.command.token) + "/callback", dpp::m_post,
+                                 goods_index_.reply(std::get<std::string>(opt.value)),
+                                 [](nlohmann::json&, const dpp::http_request_completion_t& http) {
+                                     if (http.status >= 400) {
+                                         logger->warn("Failed to answer license autocomplete, status={}",
+                                                      http.status);
+                                     }
+                                 });
             break;
         }
     });
@@ -83,43 +59,43 @@ dpp::slashcommand License_Bid::build() {
 }
 
 void License_Bid::handle_slash_interaction(const dpp::slashcommand_t& event) {
-    event.thinking();
+    defer(event);
     auto userchoice = std::get<std::string>(event.get_parameter(cmd_option_name));
     int good_type;
 
     try {
         good_type = util::as_int(userchoice);   // todo use a map later
     } catch (const std::exception&) {
-        event.edit_original_response(
-            dpp::message{fmt::format("\"{}\" is not a valid good", userchoice)}.set_flags(dpp::m_ephemeral));
+        reply(event, dpp::message{fmt::format("\"{}\" is not a valid good", userchoice)}.set_flags(dpp::m_ephemeral));
         logger->warn("invalid good choice, User {} entered {}", event.command.usr.global_name, userchoice);
         return;
     }
 
-    if (auto now = system_clock::now(); last_update_ + minutes{15} < now) {
-        license_manager_.update_state();
-        last_update_ = now;
-    }
-
-    const Good* good = lucy_->gamedata()->get_license_good(good_type);
+    auto data = lucy_->gamedata()->snapshot();
+    const Good* good = data->get_license_good(good_type);
     auto license = license_manager_.get_next_license(good_type);
 
+    if (!license && !license_manager_.ready()) {
+        license_manager_.request_refresh();
+        reply(event,
+              dpp::message{"The licenses are still being fetched, try again in a minute"}.set_flags(dpp::m_ephemeral));
+        return;
+    }
+
     if (!license) {
-        event.edit_original_response(dpp::message{fmt::format("No auction found for {}", good->name)});
+        reply(event, dpp::message{fmt::format("No auction found for {}", good->name)});
         // .set_flags(dpp::m_ephemeral));
         return;
     }
 
     if (license_manager_.is_currently_active(*license)) {
-        event.edit_original_response(
-            dpp::message{fmt::format("A license auction for {} is active right now!", good->name)});
+        reply(event, dpp::message{fmt::format("A license auction for {} is active right now!", good->name)});
         // .set_flags(dpp::m_ephemeral));
         return;
     }
 
-    if (has_license_reminder(license->id, event.command.usr.id)) {
-        event.edit_original_response(
-            dpp::message{fmt::format("A reminder is already ongoing for the next license of {}", good->name)});
+    if (reminders_.has(license->id, event.command.usr.id)) {
+        reply(event, dpp::message{fmt::format("A reminder is already ongoing for the next license of {}", good->name)});
         // .set_flags(dpp::m_ephemeral));
         return;
     }
@@ -129,80 +105,28 @@ void License_Bid::handle_slash_interaction(const dpp::slashcommand_t& event) {
                   util::fmt_to_hr_min_sec(license_manager_.get_start_tp(*license) - system_clock::now()),
                   util::fmt_to_hr_min_sec(license_manager_.get_end_tp(*license) - system_clock::now()));
 
-    event.edit_original_response(
-        dpp::message{fmt::format("An auction for {} will start {}, I will remind you", good->name,
-                                 util::timepoint_to_discord_timestamp(license_manager_.get_start_tp(*license)))});
+    const auto starts = util::timepoint_to_discord_timestamp(license_manager_.get_start_tp(*license));
+    reply(event, dpp::message{fmt::format("An auction for {} will start {}, I will remind you", good->name, starts)});
     // .set_flags(dpp::m_ephemeral));
 }
 
 std::optional<std::string> License_Bid::handler_prefix() { return {prefix_license_bid}; }
 
-std::vector<dpp::snowflake> License_Bid::users_to_remind(const std::string& id) {
-    std::lock_guard<std::mutex> lock{mtx_};
-    auto found = license_reminders_.find(id);
-    if (found != license_reminders_.end()) {
-        return found->second;
-    } else {
-        return {};
-    }
-}
-
 void License_Bid::add_reminder(const License& license, const dpp::slashcommand_t& event) {
-    std::lock_guard<std::mutex> lock{mtx_};
-    const auto& usr = event.command.usr;
-
-    if (auto reminder = license_reminders_.find(license.id); reminder != license_reminders_.end()) {
-        reminder->second.push_back(usr.id);
-    } else {
-        auto inserted = license_reminders_.insert({license.id, {}});
-        inserted.first->second.push_back(usr.id);
-    }
-
-    if (has_active_reminder(license.id)) {
-        return;
-    }
-
-    const auto reminder_delay =
-        duration_cast<seconds>(std::chrono::abs(license_manager_.get_start_tp(license) - system_clock::now()));
-
-    logger->debug("Creating alert timer for id: {}, {}, by user {} in {}", license.id, license.good_type,
-                  usr.global_name, util::fmt_to_hr_min_sec(reminder_delay));
-
-    dpp::timer t = util::one_shot_timer(
-        &lucy_->bot,
-        [this, license, channel = event.command.channel_id]() {
-            License::Embed_Data eb{users_to_remind(license.id), lucy_->gamedata()->get_license_good(license.good_type),
-                                   &license, license_manager_.get_end_tp(license)};
-
-            dpp::message m = util::build_license_msg(&eb);
-            m.set_channel_id(channel);
-            lucy_->bot.message_create(m);
-            remove_reminder(license.id);
-            license_manager_.update_state();
-        },
-        static_cast<uint64_t>(reminder_delay.count()));
-    active_timers_.insert({license.id, t});
+    reminders_.add(license, license_manager_.get_start_tp(license), license_manager_.get_end_tp(license),
+                   event.command.channel_id, event.command.usr.id);
 }
 
-void License_Bid::remove_reminder(const std::string& id) {
-    std::lock_guard<std::mutex> lock{mtx_};
-    license_reminders_.erase(id);
-    active_timers_.erase(id);
-}
+void License_Bid::send_reminder(const License_Reminders::Reminder& reminder) {
+    auto data = lucy_->gamedata()->snapshot();
+    License::Embed_Data eb{{reminder.users.begin(), reminder.users.end()},
+                           data->get_license_good(reminder.license.good_type), &reminder.license, reminder.ends_at};
 
-bool License_Bid::has_license_reminder(const std::string& id, dpp::snowflake user) {
-    std::lock_guard<std::mutex> lock{mtx_};
-    auto license_alert = license_reminders_.find(id);
-    if (license_alert != license_reminders_.end()) {
-        for (const auto& u : license_alert->second) {
-            if (user == u) {
-                return true;
-            }
-        }
+    for (auto& m : util::build_license_msgs(&eb)) {
+        m.set_channel_id(reminder.channel);
+        lucy_->bot.message_create(m);
     }
-    return false;
+    license_manager_.request_refresh();
 }
 
-bool License_Bid::has_active_reminder(const std::string& id) { return active_timers_.find(id) != active_timers_.end(); }
-
 }   // namespace railcord::cmd
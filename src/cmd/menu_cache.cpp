@@ -0,0 +1,30 @@
+#include "menu_cache.h"
+
+namespace railcord::cmd {
+
+Menu_Cache::Menu Menu_Cache::get(uint32_t key, uint64_t version, const Render_Fn& render, clock::duration max_age) {
+    const auto now = clock::now();
+    {
+        std::lock_guard<std::mutex> lock{mtx_};
+        if (version > version_) {
+            version_ = version;
+            menus_.clear();
+        }
+
+        auto found = menus_.find(key);
+        if (version == version_ && found != menus_.end() && now - found->second.rendered_at < max_age) {
+            return found->second.menu;
+        }
+    }
+
+    // rendered unlocked, it is only kept if no newer version was seen meanwhile
+    Menu menu = std::make_shared<const dpp::message>(render());
+
+    std::lock_guard<std::mutex> lock{mtx_};
+    if (version == version_) {
+        menus_.insert_or_assign(key, Entry{menu, now});
+    }
+    return menu;
+}
+
+}   // namespace railcord::cmd
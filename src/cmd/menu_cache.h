@@ -0,0 +1,39 @@
+#ifndef MENU_CACHE_H
+#define MENU_CACHE_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include <dpp/dpp.h>
+
+namespace railcord::cmd {
+
+// Rendered menu messages by key. All of them are dropped once a newer configuration version is seen, so navigating
+// menus only renders again after something they show was changed
+class Menu_Cache {
+  public:
+    using clock = std::chrono::steady_clock;
+    using Menu = std::shared_ptr<const dpp::message>;
+    using Render_Fn = std::function<dpp::message()>;
+
+    // version has to be read before anything the menu shows, a render older than max_age is done again
+    Menu get(uint32_t key, uint64_t version, const Render_Fn& render, clock::duration max_age = clock::duration::max());
+
+  private:
+    struct Entry {
+        Menu menu;
+        clock::time_point rendered_at;
+    };
+
+    std::mutex mtx_;
+    uint64_t version_{0};
+    std::unordered_map<uint32_t, Entry> menus_;
+};
+
+}   // namespace railcord::cmd
+
+#endif   // !MENU_CACHE_H
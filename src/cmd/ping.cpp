@@ -8,13 +8,21 @@ using namespace std::chrono;
 
 Ping::Ping(Lucy* lucy) : Base_Cmd("ping", "Ping pong!", seconds{3}, lucy) {}
 
-dpp::slashcommand Ping::build() { return dpp::slashcommand(name_, description_, lucy_->bot.me.id); }
+dpp::slashcommand Ping::build() {
+    return add_world_option(dpp::slashcommand(name_, description_, lucy_->bot.me.id), lucy_);
+}
 
 void Ping::handle_slash_interaction(const dpp::slashcommand_t& event) {
+    World* world = selected_world(event, lucy_);
+    if (!world) {
+        reply(event, dpp::message{"Unknown world!"}.set_flags(dpp::m_ephemeral));
+        return;
+    }
+
     dpp::message m{};
-    m.set_content(fmt::format("<@&{}> pong", uint64_t(lucy_->alert_manager()->get_alert_role())));
+    m.set_content(fmt::format("<@&{}> pong", uint64_t(world->alert_manager()->get_alert_role())));
     m.allowed_mentions.parse_roles = true;
-    event.reply(m);
+    reply(event, m);
 }
 
 }   // namespace railcord::cmd
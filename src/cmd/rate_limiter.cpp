@@ -0,0 +1,70 @@
+#include <algorithm>
+#include <mutex>
+
+#include "rate_limiter.h"
+
+namespace railcord::cmd {
+using namespace std::chrono;
+
+static int64_t now_ns() { return duration_cast<nanoseconds>(Rate_Limiter::clock::now().time_since_epoch()).count(); }
+
+Rate_Limiter::Rate_Limiter(Rate_Limit limit)
+    : limit_(limit), period_(duration_cast<nanoseconds>(limit.refill).count()),
+      tolerance_(period_ * (std::max<uint32_t>(limit.burst, 1) - 1)) {}
+
+milliseconds Rate_Limiter::acquire(uint64_t user) {
+    if (period_ <= 0) {
+        return milliseconds::zero();
+    }
+
+    const int64_t now = now_ns();
+    Shard& s = shard(user);
+    {
+        std::shared_lock<std::shared_mutex> lock{s.mtx};
+        auto found = s.buckets.find(user);
+        if (found != s.buckets.end()) {
+            return take(found->second, now);
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock{s.mtx};
+    auto [it, inserted] = s.buckets.try_emplace(user, now);   // a full bucket
+    return take(it->second, now);
+}
+
+milliseconds Rate_Limiter::take(std::atomic<int64_t>& full_at, int64_t now) const {
+    int64_t current = full_at.load(std::memory_order_relaxed);
+    for (;;) {
+        const int64_t allowed_at = current - tolerance_;
+        if (now < allowed_at) {
+            return ceil<milliseconds>(nanoseconds{allowed_at - now});
+        }
+
+        if (full_at.compare_exchange_weak(current, std::max(current, now) + period_, std::memory_order_relaxed)) {
+            return milliseconds::zero();
+        }
+    }
+}
+
+size_t Rate_Limiter::evict_idle() {
+    const int64_t now = now_ns();
+    size_t evicted = 0;
+    for (Shard& s : shards_) {
+        std::unique_lock<std::shared_mutex> lock{s.mtx};
+        for (auto it = s.buckets.begin(); it != s.buckets.end();) {
+            if (it->second.load(std::memory_order_relaxed) <= now) {
+                it = s.buckets.erase(it);
+                ++evicted;
+            } else {
+                ++it;
+            }
+        }
+    }
+    return evicted;
+}
+
+Rate_Limiter::Shard& Rate_Limiter::shard(uint64_t user) {
+    return shards_[(user ^ (user >> 22)) % s_shards];   // mix the snowflake timestamp into its counter bits
+}
+
+}   // namespace railcord::cmd
@@ -0,0 +1,57 @@
+#ifndef RATE_LIMITER_H
+#define RATE_LIMITER_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace railcord::cmd {
+
+// burst uses in a row, then one more every refill
+struct Rate_Limit {
+    uint32_t burst{1};
+    std::chrono::milliseconds refill{0};
+};
+
+// Token bucket per user for one command. A bucket is the time it is full again (GCRA), updated with a CAS so users
+// only share a lock when they are first seen or evicted
+class Rate_Limiter {
+  public:
+    using clock = std::chrono::steady_clock;
+
+    explicit Rate_Limiter(Rate_Limit limit);
+    Rate_Limiter(const Rate_Limiter&) = delete;
+    Rate_Limiter& operator=(const Rate_Limiter&) = delete;
+
+    // Takes a token, zero if one was available otherwise the time until the next one
+    std::chrono::milliseconds acquire(uint64_t user);
+
+    // Drops the buckets that are full again, returns how many
+    size_t evict_idle();
+
+    const Rate_Limit& limit() const { return limit_; }
+
+    static constexpr size_t s_shards = 16;
+
+  private:
+    struct Shard {
+        std::shared_mutex mtx;
+        std::unordered_map<uint64_t, std::atomic<int64_t>> buckets;   // full at, ns since the clock epoch
+    };
+
+    std::chrono::milliseconds take(std::atomic<int64_t>& full_at, int64_t now) const;
+    Shard& shard(uint64_t user);
+
+    Rate_Limit limit_;
+    int64_t period_;      // ns per token
+    int64_t tolerance_;   // ns of burst on top of the current token
+    std::array<Shard, s_shards> shards_;
+};
+
+}   // namespace railcord::cmd
+
+#endif   // !RATE_LIMITER_H
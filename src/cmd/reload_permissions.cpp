@@ -0,0 +1,22 @@
+#include "commands.h"
+#include "logger.h"
+#include "lucy.h"
+
+namespace railcord::cmd {
+using namespace std::chrono;
+
+Reload_Permissions::Reload_Permissions(Lucy* lucy)
+    : Base_Cmd("reload_permissions", "Reload who can use the commands from the settings file", seconds{10}, lucy) {}
+
+dpp::slashcommand Reload_Permissions::build() { return dpp::slashcommand(name_, description_, lucy_->bot.me.id); }
+
+void Reload_Permissions::handle_slash_interaction(const dpp::slashcommand_t& event) {
+    logger->info("User {} reloading permissions", event.command.usr.global_name);
+    if (lucy_->reload_permissions()) {
+        reply(event, dpp::message{"Permissions reloaded"}.set_flags(dpp::m_ephemeral));
+    } else {
+        reply(event, dpp::message{"!! Something went wrong reloading permissions"}.set_flags(dpp::m_ephemeral));
+    }
+}
+
+}   // namespace railcord::cmd
@@ -9,15 +9,20 @@ namespace railcord::cmd {
 using namespace std::chrono;
 
 constexpr const char* prefix_remove_custom_message = "removecmsg";
-constexpr const char* remove_custom_message_select_click = "rmcmselect";
+
+enum class Remove_Action : char { select_click = 's' };   // world
+using Remove_Id = Custom_Id<Remove_Action>;
 
 Remove_Custom_Message::Remove_Custom_Message(Lucy* lucy)
-    : Base_Cmd("remove_custom_message", "Remove a custom message for the alerts", seconds{3}, lucy) {}
+    : Base_Cmd("remove_custom_message", "Remove a custom message for the alerts", seconds{3}, lucy),
+      menus_(lucy->worlds()->all().size()) {}
 
-dpp::slashcommand Remove_Custom_Message::build() { return dpp::slashcommand(name_, description_, lucy_->bot.me.id); }
+dpp::slashcommand Remove_Custom_Message::build() {
+    return add_world_option(dpp::slashcommand(name_, description_, lucy_->bot.me.id), lucy_);
+}
 
-static dpp::message build_custom_message_menu(Lucy* lucy) {
-    Alert_Manager* alert_manager = lucy->alert_manager();
+static dpp::message build_custom_message_menu(Lucy* lucy, World* world) {
+    Alert_Manager* alert_manager = world->alert_manager();
     std::vector<dpp::select_option> options;
     auto custom_msgs = alert_manager->get_custom_msgs();
 
@@ -34,7 +39,8 @@ static dpp::message build_custom_message_menu(Lucy* lucy) {
         dpp::component()
             .set_type(dpp::cot_selectmenu)
             .set_placeholder("Remove message")
-            .set_id(build_id(prefix_remove_custom_message, remove_custom_message_select_click));
+            .set_id(Remove_Id::encode(prefix_remove_custom_message, Remove_Action::select_click,
+                                      world_field(world, lucy)));
 
     for (auto&& opt : options) {
         select_menu.add_select_option(opt);
@@ -48,16 +54,38 @@ static dpp::message build_custom_message_menu(Lucy* lucy) {
 }
 
 void Remove_Custom_Message::handle_slash_interaction(const dpp::slashcommand_t& event) {
-    event.reply(build_custom_message_menu(lucy_));
+    World* world = selected_world(event, lucy_);
+    if (!world) {
+        reply(event, dpp::message{"Unknown world!"}.set_flags(dpp::m_ephemeral));
+        return;
+    }
+
+    reply(event, *menu(world));
 }
 
 void Remove_Custom_Message::handle_select_click(const dpp::select_click_t& event) {
-    int id = std::stoi(event.values[0]);
-    lucy_->alert_manager()->remove_custom_message(id);
-    logger->info("Removing custom msg id={} by user {}", id, event.command.usr.global_name);
-    event.reply(dpp::ir_update_message, build_custom_message_menu(lucy_));
+    auto custom_id = Remove_Id::decode(event.custom_id, prefix_remove_custom_message);
+    World* world = custom_id && custom_id->action == Remove_Action::select_click && custom_id->field_count == 1
+                       ? lucy_->worlds()->at((*custom_id)[0])
+                       : nullptr;
+    const auto id = select_value(event);
+    if (!world || !id) {
+        logger->warn("Malformed remove message id \"{}\"", event.custom_id);
+        reply(event);
+        return;
+    }
+
+    world->alert_manager()->remove_custom_message(*id);
+    logger->info("Removing custom msg id={} by user {}", *id, event.command.usr.global_name);
+    reply(event, dpp::ir_update_message, *menu(world));
 }
 
 std::optional<std::string> Remove_Custom_Message::handler_prefix() { return {prefix_remove_custom_message}; }
 
+Menu_Cache::Menu Remove_Custom_Message::menu(World* world) {
+    const uint64_t version = world->alert_manager()->config_version();
+    return menus_[world_field(world, lucy_)].get(0, version,
+                                                 [this, world]() { return build_custom_message_menu(lucy_, world); });
+}
+
 }   // namespace railcord::cmd
@@ -8,12 +8,20 @@ using namespace std::chrono;
 
 Set_channel::Set_channel(Lucy* lucy) : Base_Cmd("set_channel", "Sets the channel for workers", seconds{5}, lucy) {}
 
-dpp::slashcommand Set_channel::build() { return dpp::slashcommand(name_, description_, lucy_->bot.me.id); }
+dpp::slashcommand Set_channel::build() {
+    return add_world_option(dpp::slashcommand(name_, description_, lucy_->bot.me.id), lucy_);
+}
 
 void Set_channel::handle_slash_interaction(const dpp::slashcommand_t& event) {
-    lucy_->alert_manager()->set_alert_channel(event.command.channel.id);
-    event.reply(
-        dpp::message{fmt::format("Watch channel set to: {}", event.command.channel.name)}.set_flags(dpp::m_ephemeral));
+    World* world = selected_world(event, lucy_);
+    if (!world) {
+        reply(event, dpp::message{"Unknown world!"}.set_flags(dpp::m_ephemeral));
+        return;
+    }
+
+    world->alert_manager()->set_alert_channel(event.command.channel.id);
+    reply(event, dpp::message{fmt::format("Watch channel of {} set to: {}", world->name(), event.command.channel.name)}
+                     .set_flags(dpp::m_ephemeral));
 }
 
 }   // namespace railcord::cmd
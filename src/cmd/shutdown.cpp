@@ -11,16 +11,16 @@ dpp::slashcommand Shutdown::build() { return dpp::slashcommand(name_, descriptio
 
 void Shutdown::handle_slash_interaction(const dpp::slashcommand_t& event) {
     if (event.command.get_issuing_user().id != Lucy::s_bot_owner) {
-        event.reply(dpp::message{"You have no permissions for this command!"}.set_flags(dpp::m_ephemeral));
+        reply(event, dpp::message{"You have no permissions for this command!"}.set_flags(dpp::m_ephemeral));
         return;
     }
     if (lucy_->is_running()) {
         logger->info("Received shutdown command, stopping..");
-        event.reply(dpp::message{"Shutting down.. bye bye"});
+        reply(event, dpp::message{"Shutting down.. bye bye"});
         lucy_->shutdown();
     } else {
         logger->warn("Shutdown command received again..");
-        event.reply(dpp::message{"Shutdown already ongoing!"}.set_flags(dpp::m_ephemeral));
+        reply(event, dpp::message{"Shutdown already ongoing!"}.set_flags(dpp::m_ephemeral));
     }
 }
 
@@ -0,0 +1,29 @@
+#include "commands.h"
+#include "lucy.h"
+#include "metrics.h"
+#include "util.h"
+
+namespace railcord::cmd {
+using namespace std::chrono;
+
+Stats::Stats(Lucy* lucy) : Base_Cmd("stats", "Show the bot metrics", seconds{5}, lucy) {}
+
+dpp::slashcommand Stats::build() { return dpp::slashcommand(name_, description_, lucy_->bot.me.id); }
+
+void Stats::handle_slash_interaction(const dpp::slashcommand_t& event) {
+    static constexpr std::string_view s_fence = "```";
+    static constexpr std::string_view s_cut = "..\n";
+
+    std::string summary = metrics.summary();
+    const size_t room = util::s_max_content - 2 * s_fence.size() - 2 - s_cut.size();
+    if (summary.size() > room) {
+        summary.resize(summary.rfind('\n', room) + 1);   // keep whole lines
+        summary.append(s_cut);
+    }
+
+    std::string content;
+    content.append(s_fence).append("\n").append(summary).append(s_fence);
+    reply(event, dpp::message{content}.set_flags(dpp::m_ephemeral));
+}
+
+}   // namespace railcord::cmd
@@ -1,3 +1,5 @@
+#include <fmt/format.h>
+
 #include "commands.h"
 #include "lucy.h"
 
@@ -6,15 +8,23 @@ using namespace std::chrono;
 
 Stop_watch::Stop_watch(Lucy* lucy) : Base_Cmd("stop_watch", "Stops watching workers", seconds{10}, lucy) {}
 
-dpp::slashcommand Stop_watch::build() { return dpp::slashcommand(name_, description_, lucy_->bot.me.id); }
+dpp::slashcommand Stop_watch::build() {
+    return add_world_option(dpp::slashcommand(name_, description_, lucy_->bot.me.id), lucy_);
+}
 
 void Stop_watch::handle_slash_interaction(const dpp::slashcommand_t& event) {
-    if (lucy_->watcher()->is_watching()) {
-        event.thinking(true);
-        lucy_->watcher()->stop();
-        event.edit_original_response(dpp::message{"Workers watch stopped!"});
+    World* world = selected_world(event, lucy_);
+    if (!world) {
+        reply(event, dpp::message{"Unknown world!"}.set_flags(dpp::m_ephemeral));
+        return;
+    }
+
+    if (world->watcher()->is_watching()) {
+        defer(event, true);
+        world->watcher()->stop();
+        reply(event, dpp::message{fmt::format("Workers watch for {} stopped!", world->name())});
     } else {
-        event.reply("Workers watch is not running!");
+        reply(event, "Workers watch is not running!");
     }
 }
 
@@ -0,0 +1,76 @@
+#include <fmt/format.h>
+
+#include "alert_manager.h"
+#include "commands.h"
+#include "logger.h"
+#include "lucy.h"
+
+namespace railcord::cmd {
+using namespace std::chrono;
+
+inline constexpr const char* s_worker_option{"worker"};
+inline constexpr const char* s_lead_time_option{"lead_time"};
+inline constexpr const char* s_enabled_option{"enabled"};
+
+Subscribe::Subscribe(Lucy* lucy)
+    : Base_Cmd("subscribe", "Get a direct message before a worker auction ends", seconds{3}, lucy) {}
+
+dpp::slashcommand Subscribe::build() {
+    dpp::command_option worker{dpp::co_integer, s_worker_option, "Worker type", true};
+    for (uint8_t t = personality::type::goods; t < personality::type::unknown; ++t) {
+        worker.add_choice(dpp::command_option_choice(personality::type{t}.description(), int64_t{t}));
+    }
+
+    dpp::command_option lead_time{dpp::co_integer, s_lead_time_option, "Minutes left to the deadline", true};
+    for (int m : Alert_Info::s_intervals) {
+        lead_time.add_choice(
+            dpp::command_option_choice(m < 60 ? fmt::format("{}m", m) : fmt::format("{}h", m / 60), int64_t{m}));
+    }
+
+    return add_world_option(
+        dpp::slashcommand(name_, description_, lucy_->bot.me.id)
+            .add_option(worker)
+            .add_option(lead_time)
+            .add_option(dpp::command_option(dpp::co_boolean, s_enabled_option, "Subscribe or unsubscribe", true)
+                            .add_choice(dpp::command_option_choice("Subscribe", true))
+                            .add_choice(dpp::command_option_choice("Unsubscribe", false))),
+        lucy_);
+}
+
+void Subscribe::handle_slash_interaction(const dpp::slashcommand_t& event) {
+    personality::type t{static_cast<int>(std::get<int64_t>(event.get_parameter(s_worker_option)))};
+    int interval = static_cast<int>(std::get<int64_t>(event.get_parameter(s_lead_time_option)));
+    bool enabled = std::get<bool>(event.get_parameter(s_enabled_option));
+    const auto& usr = event.command.usr;
+
+    World* world = selected_world(event, lucy_);
+    if (!world) {
+        reply(event, dpp::message{"Unknown world!"}.set_flags(dpp::m_ephemeral));
+        return;
+    }
+
+    // nothing changes, skip saving the subscriptions again
+    if (world->alert_manager()->is_subscribed(usr.id, t, interval) == enabled) {
+        reply(event, dpp::message{enabled ? fmt::format("You already get a DM {} minutes before {} auctions end",
+                                                        interval, t.description())
+                                          : fmt::format("You don't get DMs {} minutes before {} auctions end",
+                                                        interval, t.description())}
+                         .set_flags(dpp::m_ephemeral));
+        return;
+    }
+
+    if (!world->alert_manager()->set_subscription(usr.id, t, interval, enabled)) {
+        reply(event, dpp::message{"Invalid subscription"}.set_flags(dpp::m_ephemeral));
+        return;
+    }
+
+    logger->info("User {} {} type={} interval={}", usr.global_name, enabled ? "subscribed to" : "unsubscribed from",
+                 t.t, interval);
+    reply(event, dpp::message{enabled ? fmt::format("I will DM you {} minutes before {} auctions end", interval,
+                                                    t.description())
+                                      : fmt::format("No more DMs {} minutes before {} auctions end", interval,
+                                                    t.description())}
+                     .set_flags(dpp::m_ephemeral));
+}
+
+}   // namespace railcord::cmd
@@ -1,3 +1,8 @@
+#include <algorithm>
+#include <cassert>
+
+#include <fmt/format.h>
+
 #include "commands.h"
 #include "lucy.h"
 
@@ -7,21 +12,56 @@ using namespace std::chrono;
 Watch::Watch(Lucy* lucy) : Base_Cmd("watch", "Starts watching workers", seconds{10}, lucy) {}
 
 inline constexpr const char* s_horizon_cmd_option{"active_only_horizon_msg"};
+inline constexpr const char* s_world_cmd_option{"world"};
+inline constexpr size_t s_max_choices = 25;   // discord limit
+
+dpp::slashcommand add_world_option(dpp::slashcommand cmd, Lucy* lucy) {
+    const auto& worlds = lucy->worlds()->all();
+    if (worlds.size() < 2) {
+        return cmd;
+    }
+
+    dpp::command_option option{dpp::co_string, s_world_cmd_option, "Gameworld, the main one if not given", false};
+    for (size_t i = 0; i < std::min(worlds.size(), s_max_choices); ++i) {
+        option.add_choice(dpp::command_option_choice(worlds[i]->name(), worlds[i]->name()));
+    }
+    return cmd.add_option(option);
+}
+
+World* selected_world(const dpp::slashcommand_t& event, Lucy* lucy) {
+    auto param = event.get_parameter(s_world_cmd_option);
+    const auto* name = std::get_if<std::string>(&param);
+    return lucy->worlds()->get(name ? *name : std::string_view{});
+}
+
+uint8_t world_field(const World* world, Lucy* lucy) {
+    const size_t index = lucy->worlds()->index_of(world);
+    assert(index < s_max_choices && "only the selectable worlds have menus");
+    return static_cast<uint8_t>(index);
+}
 
 dpp::slashcommand Watch::build() {
-    return dpp::slashcommand(name_, description_, lucy_->bot.me.id)
-        .add_option(dpp::command_option(dpp::co_boolean, s_horizon_cmd_option,
-                                        "Only sends horizon messages for active alerts", true)
-                        .add_choice(dpp::command_option_choice("Enabled", true))
-                        .add_choice(dpp::command_option_choice("Disabled", false)));
+    return add_world_option(dpp::slashcommand(name_, description_, lucy_->bot.me.id)
+                                .add_option(dpp::command_option(dpp::co_boolean, s_horizon_cmd_option,
+                                                                "Only sends horizon messages for active alerts", true)
+                                                .add_choice(dpp::command_option_choice("Enabled", true))
+                                                .add_choice(dpp::command_option_choice("Disabled", false))),
+                            lucy_);
 }
 
 void Watch::handle_slash_interaction(const dpp::slashcommand_t& event) {
-    if (lucy_->watcher()->is_watching()) {
-        event.reply(dpp::message{"Already watching!"}.set_flags(dpp::m_ephemeral));
+    World* world = selected_world(event, lucy_);
+    if (!world) {
+        reply(event, dpp::message{"Unknown world!"}.set_flags(dpp::m_ephemeral));
+        return;
+    }
+
+    personality_watcher* watcher = world->watcher();
+    if (watcher->is_watching()) {
+        reply(event, dpp::message{"Already watching!"}.set_flags(dpp::m_ephemeral));
     } else {
-        event.reply(dpp::message{"Starting workers watch.."}.set_flags(dpp::m_ephemeral));
-        personality_watcher* watcher = lucy_->watcher();
+        reply(event, dpp::message{fmt::format("Starting workers watch for {}..", world->name())}.set_flags(
+                         dpp::m_ephemeral));
         watcher->set_active_only_horizon_msg(std::get<bool>(event.get_parameter(s_horizon_cmd_option)));
         watcher->run();
     }
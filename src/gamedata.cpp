@@ -1,23 +1,41 @@
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <filesystem>
 #include <fstream>
+#include <future>
+#include <iterator>
+#include <random>
+#include <utility>
 
-#include <pugixml.hpp>
+#ifdef __linux__
+#define GAMEDATA_USE_INOTIFY
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
 
 #include "gamedata.h"
 #include "logger.h"
+#include "lucyapi.h"
+#include "tmx_scanner.h"
+#include "util.h"
 
 namespace railcord {
 
 #define DESCRIPTION_PLACEHOLDER "%0"
 #define RESOURCE_PATH(g, r) (std::string{}.append("resources/").append(g).append(r))
 
-inline constexpr char s_name_fmt[]{"IDS_PERSONALITY_NAME_"};
-inline constexpr char s_effect_fmt[]{"IDS_PERSONALITY_EFFECT_"};
+// order of the sources in the cache header
+inline constexpr size_t s_personalities_src = 0;
+inline constexpr size_t s_goods_src = 1;
+inline constexpr size_t s_effects_src = 2;
+inline constexpr size_t s_gamedata_src = 3;
+inline constexpr size_t s_source_count = 4;
 
-typedef std::unordered_map<int, std::string> str_map;
 typedef std::unordered_map<int, personality::information> pstats_map;
-typedef std::pair<str_map, str_map> names_desc;
 using json = nlohmann::json;
+using namespace std::chrono;
+namespace fs = std::filesystem;
 
 static pstats_map load_personality_stats(const std::string& stats_file) {
     logger->debug("Loading personality stats...");
@@ -38,179 +56,334 @@ static pstats_map load_personality_stats(const std::string& stats_file) {
     return stats;
 }
 
-static names_desc load_personality_names_desc(const std::string& gamedata_file, const pstats_map& p_stats) {
+template <typename F>
+static auto timed(const char* phase, F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    auto res = f();
+    logger->debug("Loading {} took {:.3f}s", phase,
+                  std::chrono::duration_cast<std::chrono::duration<float>>(std::chrono::steady_clock::now() - start)
+                      .count());
+    return res;
+}
+
+// Fill the effect value into the description template of a personality
+static std::string format_description(std::string description, const personality::information& info) {
     typedef railcord::personality::type type;
-    logger->debug("Parsing personality names and descriptions...");
+    unsigned delete_percent{};
+
+    switch (info.ptype.t) {
+        case type::hourly:
+            [[fallthrough]];
+        case type::speed:
+            [[fallthrough]];
+        case type::research:
+            ++delete_percent;
+            break;
+        default:
+            break;
+    }
 
-    // skip extra personalities not used in the current stats data file
-    auto not_found = [](int id, auto& map) -> bool {
-        auto iter = map.find(id);
-        return iter == map.end();
-    };
+    auto placeholder_idx = description.find(DESCRIPTION_PLACEHOLDER);
+    if (placeholder_idx != std::string::npos) {
+        description.erase(placeholder_idx + 1 - delete_percent, 1 + delete_percent);
+        description.insert(placeholder_idx, std::to_string(info.effect));
+    }
+    return description;
+}
+
+static std::vector<gdcache::Resource_Entry> load_gameresource(const std::string& file_name) {
+    logger->debug("Loading file {}", file_name);
+
+    std::ifstream stream{file_name};
+    if (!stream.is_open()) {
+        throw std::runtime_error{fmt::format("Could not open {} file", file_name)};
+    }
 
-    auto starts_with = [](const auto& needle, const auto& value) -> bool {
-        return ::strncmp(needle, value, ::strlen(needle)) == 0;
+    try {
+        return json::parse(stream).get<std::vector<gdcache::Resource_Entry>>();
+    } catch (const json::exception& e) {
+        logger->error("{}", e.what());
+        throw;
+    }
+}
+
+static gdcache::Contents load_sources(const std::vector<std::string>& sources) {
+    const auto load = [](const char* phase, auto f, std::string path) {
+        return std::async(std::launch::async, [phase, f, path]() { return timed(phase, [&]() { return f(path); }); });
     };
 
-    // pray for no unicod/wide strs o_o
-    auto get_id = [](auto str, auto sz) -> int { return std::atoi(static_cast<const char*>(&(str)[sz])); };
+    // independent files, the xml is by far the largest
+    const auto scan_tmx = [](const std::string& path) { return Tmx_Strings::scan(path); };
+    auto tmx_f = load("gamedata xml", scan_tmx, sources[s_gamedata_src]);
+    auto stats_f = load("personalities", load_personality_stats, sources[s_personalities_src]);
+    auto goods = load("goods", load_gameresource, sources[s_goods_src]);
+    auto effects = load("effects", load_gameresource, sources[s_effects_src]);
 
-    pugi::xml_document doc;
-    pugi::xml_parse_result res = doc.load_file(gamedata_file.c_str());
+    gdcache::Contents contents;
+    pstats_map stats = stats_f.get();
+    contents.goods = goods.get();
+    contents.effects = effects.get();
+    Tmx_Strings tmx = tmx_f.get();
+    const auto& strings = *tmx.locale("");
 
-    if (!res) {
-        logger->error("Could not parse personality names and descriptions: {}", res.description());
-        throw std::runtime_error{res.description()};
+    // skip extra personalities not used in the current stats data file
+    contents.personalities.reserve(stats.size());
+    for (const auto& [id, stat] : stats) {
+        contents.personalities.push_back({stat, Tmx_Strings::decode(strings.names.at(id)),
+                                          format_description(Tmx_Strings::decode(strings.descriptions.at(id)), stat)});
     }
 
-    pugi::xml_node items = doc.child("tmx").child("body");
-    std::unordered_map<int, std::string> all_names;
-    std::unordered_map<int, std::string> all_descriptions;
+    std::sort(contents.personalities.begin(), contents.personalities.end(),
+              [](const auto& a, const auto& b) { return a.info.id < b.info.id; });
+    return contents;
+}
 
-    for (auto item : items) {
-        for (auto attr : item.attributes()) {
-            if (starts_with(s_name_fmt, attr.as_string())) {
+std::vector<std::string> Game_Dataset::sources(const std::string& game_mode) {
+    std::vector<std::string> sources(s_source_count);
+    sources[s_personalities_src] = RESOURCE_PATH(game_mode, "_personalities.json");
+    sources[s_goods_src] = RESOURCE_PATH(game_mode, "_goods.json");
+    sources[s_effects_src] = RESOURCE_PATH(game_mode, "_personality_effects.json");
+    sources[s_gamedata_src] = RESOURCE_PATH(game_mode, "_gamedata.xml");
+    return sources;
+}
 
-                int id = get_id(attr.as_string(), sizeof(s_name_fmt) - 1);
+std::shared_ptr<const Game_Dataset> Game_Dataset::load(const std::string& game_mode, Resource_Pool* pool) {
+    util::Phase_Timer timer{"Gamedata load"};
+    const auto sources = Game_Dataset::sources(game_mode);
+    const std::string cache_path = RESOURCE_PATH(game_mode, "_gamedata.cache");
 
-                if (not_found(id, p_stats)) {
-                    continue;
-                }
+    auto cache = GameData_Cache::open(cache_path, sources);
+    timer.lap("open cache");
 
-                all_names.insert(std::make_pair(id, item.child("tuv").child("seg").text().get()));
+    if (!cache) {
+        logger->info("Building gamedata cache for {}", game_mode);
+        auto stamps = GameData_Cache::stamp(sources);
+        cache = GameData_Cache::create(cache_path, stamps, load_sources(sources));
+        timer.lap("build cache");
+    }
 
-            } else if (starts_with(s_effect_fmt, attr.as_string())) {
-                int id = get_id(attr.as_string(), sizeof(s_effect_fmt) - 1);
+    std::shared_ptr<Game_Dataset> data{new Game_Dataset};
+    data->cache_ = std::make_shared<const GameData_Cache>(std::move(*cache));
+    data->load_cache(pool);
+    timer.lap("load cache");
+    timer.finish();
+    return data;
+}
 
-                if (not_found(id, p_stats)) {
-                    continue;
-                }
+void Game_Dataset::load_cache(Resource_Pool* pool) {
+    resources_ = pool ? pool->intern(cache_) : Resource_Pool{}.intern(cache_);
+    const auto& all_goods = resources_->goods;
+    const auto& all_effects = resources_->effects;
 
-                const auto& info = p_stats.at(id);
-                std::string description = item.child("tuv").child("seg").text().get();
-
-                unsigned delete_percent{};
-
-                switch (info.ptype.t) {
-                    case type::hourly:
-                        [[fallthrough]];
-                    case type::speed:
-                        [[fallthrough]];
-                    case type::research:
-                        ++delete_percent;
-                        break;
-                    default:
-                        break;
-                }
+    if (all_goods.empty()) {
+        throw std::runtime_error{"Gamedata has no goods"};
+    }
+    if (all_goods.size() + all_effects.size() >= personality::s_no_icon) {
+        throw std::runtime_error{"Too many gamedata resources for an icon reference"};
+    }
 
-                auto placeholder_idx = description.find(DESCRIPTION_PLACEHOLDER);
-                if (placeholder_idx != std::string::npos) {
-                    description.erase(placeholder_idx + 1 - delete_percent, 1 + delete_percent);
-                    description.insert(placeholder_idx, std::to_string(info.effect));
-                }
-                all_descriptions.insert(std::make_pair(id, std::move(description)));
-            }
-        }
+    // records are sorted by id
+    personalities_.clear();
+    personalities_.reserve(cache_->personality_count());
+    for (uint32_t i = 0; i < cache_->personality_count(); ++i) {
+        const auto& r = cache_->personalities()[i];
+        personality::information info{
+            r.id, r.effect, personality::type{r.type}, r.art_id, {r.goods_id[0], r.goods_id[1]}};
+        const auto [main, sec] = get_icons(info);
+        personalities_.emplace_back(info, this, r.name, r.description, main, sec);
     }
 
-    return {all_names, all_descriptions};
+    unknow_ = personality{personality::information{}, this, cache_->unknown_name(), cache_->unknown_description(), 0, 0};
+    build_indices();
+    build_renders();
+    logger->debug("Loaded {} personalities, {} goods, {} effects from a {} bytes cache", personalities_.size(),
+                  goods().size(), personality_effects().size(), cache_->size());
 }
 
-static std::deque<GameResource> load_gameresource(const std::string& file_name) {
-    logger->debug("Loading file {}", file_name);
+const personality* Game_Dataset::find_personality(int id) const {
+    if (!id_index_.empty()) {
+        if (id >= 0 && static_cast<size_t>(id) < id_index_.size() && id_index_[id] != s_no_index) {
+            return &personalities_[id_index_[id]];
+        }
+        return nullptr;
+    }
 
-    std::ifstream stream{file_name};
-    if (!stream.is_open()) {
-        throw std::runtime_error{fmt::format("Could not open {} file", file_name)};
+    auto found = std::lower_bound(personalities_.begin(), personalities_.end(), id,
+                                  [](const personality& p, int id) { return p.info.id < id; });
+    return found != personalities_.end() && found->info.id == id ? &*found : nullptr;
+}
+
+const personality& Game_Dataset::get_rnd_personality(personality::type t) const {
+    const auto& of_type = personalities_of_type(t);
+    if (of_type.empty()) {
+        return unknow_;
     }
 
-    try {
-        return json::parse(stream).get<std::deque<GameResource>>();
-    } catch (const json::exception& e) {
-        logger->error("{}", e.what());
-        throw;
+    thread_local std::mt19937 gen{std::random_device{}()};
+    std::uniform_int_distribution<size_t> dis{0, of_type.size() - 1};
+    return personalities_[of_type[dis(gen)]];
+}
+
+void Game_Dataset::build_renders() {
+    const auto art = api_endpoints.find(api::worker_art_id);
+    const std::string art_endpoint = art != api_endpoints.end() ? art->second : std::string{};
+
+    const auto render = [&art_endpoint](const personality& p) {
+        Render r;
+        r.art_url.reserve(art_endpoint.size() + 16);
+        r.art_url.append(art_endpoint).append(std::to_string(p.info.art_id)).append(".png");
+
+        dpp::embed& e = r.embed;
+        e.add_field("", std::string{p.description()});
+
+        dpp::embed_author author;
+        author.icon_url = r.art_url;
+        author.name = std::string{p.name()};
+        e.set_author(author);
+
+        dpp::embed_footer footer{};
+        footer.set_text(util::s_inv_space);
+        footer.set_icon(std::string{p.sec_icon()});
+        e.set_footer(footer);
+
+        e.set_image(std::string{p.main_icon()});
+        e.set_thumbnail(r.art_url);
+        return r;
+    };
+
+    renders_.clear();
+    renders_.reserve(personalities_.size() + 1);
+    for (const auto& p : personalities_) {
+        renders_.push_back(render(p));
     }
+    renders_.push_back(render(unknow_));
 }
 
-void GameData::init(const std::string& game_mode) {
-    pstats_map stats = load_personality_stats(RESOURCE_PATH(game_mode, "_personalities.json"));
-    goods_ = load_gameresource(RESOURCE_PATH(game_mode, "_goods.json"));
-    pEffects_ = load_gameresource(RESOURCE_PATH(game_mode, "_personality_effects.json"));
-    const auto& [names, descriptions] = load_personality_names_desc(RESOURCE_PATH(game_mode, "_gamedata.xml"), stats);
-    for (const auto& [id, stat] : stats) {
-        const auto& [main, sec] = get_icons(stat);
-        personalities_.try_emplace(id, stats.at(id), names.at(id), descriptions.at(id), main, sec);
+size_t Game_Dataset::render_index(const personality& p) const {
+    if (!personalities_.empty() && &p >= &personalities_.front() && &p <= &personalities_.back()) {
+        return static_cast<size_t>(&p - personalities_.data());
     }
+    assert(&p == &unknow_ && "Personality of another dataset");
+    return personalities_.size();
+}
 
-    assert(goods_.size() > 0);
-    unknow_ = personality{personality::information{}, "Unkown", "Unkown personality", &goods_.front().icon_url,
-                          &goods_.front().icon_url};
+const std::vector<uint32_t>& Game_Dataset::personalities_of_type(personality::type t) const {
+    return by_type_[t < personality::type::unknown ? t.t : personality::type::unknown];
 }
 
-const personality& GameData::get_personality(int id) const { return personalities_.at(id); }
+void Game_Dataset::build_indices() {
+    id_index_.clear();
+    const int max_id = personalities_.empty() ? -1 : personalities_.back().info.id;
+    if (max_id >= 0 && max_id < s_max_flat_id && personalities_.front().info.id >= 0) {
+        id_index_.assign(static_cast<size_t>(max_id) + 1, s_no_index);
+        for (uint32_t i = 0; i < personalities_.size(); ++i) {
+            id_index_[personalities_[i].info.id] = i;
+        }
+    }
 
-const personality& GameData::get_rnd_personality(personality::type t) const {
+    for (auto& of_type : by_type_) {
+        of_type.clear();
+    }
 
-    for (const auto& [id, p] : personalities_) {
-        if (p.info.ptype == t) {
-            return p;
-        }
+    for (uint32_t i = 0; i < personalities_.size(); ++i) {
+        by_type_[std::min<uint8_t>(personalities_[i].info.ptype.t, personality::type::unknown)].push_back(i);
+    }
+
+    for (auto& of_type : by_type_) {
+        std::sort(of_type.begin(), of_type.end(), [this](uint32_t a, uint32_t b) {
+            const auto& pa = personalities_[a].info;
+            const auto& pb = personalities_[b].info;
+            return std::make_pair(pa.effect, pa.id) < std::make_pair(pb.effect, pb.id);
+        });
     }
-    // not found
-    return unknow_;
 }
 
-const std::deque<Good>& GameData::goods() const { return goods_; }
+GameIconUrl Game_Dataset::icon(personality::icon_ref ref) const {
+    const auto& all_goods = goods();
+    const auto& all_effects = personality_effects();
+    if (ref < all_goods.size()) {
+        return all_goods[ref].icon_url;
+    }
+    if (ref - all_goods.size() < all_effects.size()) {
+        return all_effects[ref - all_goods.size()].icon_url;
+    }
+    return {};
+}
 
-const std::deque<Good>& GameData::personality_effects() const { return pEffects_; }
+size_t Game_Dataset::memory_usage() const {
+    size_t bytes = sizeof(*this) + cache_->size() + personalities_.capacity() * sizeof(personality) +
+                   id_index_.capacity() * sizeof(uint32_t);
+    for (const auto& of_type : by_type_) {
+        bytes += of_type.capacity() * sizeof(uint32_t);
+    }
+    for (const auto& r : renders_) {
+        bytes += sizeof(Render) + r.art_url.capacity() + r.embed.fields.front().value.capacity() +
+                 r.embed.author->name.capacity() + r.embed.author->icon_url.capacity();
+    }
+    bytes += (resources_->goods.capacity() + resources_->effects.capacity()) * sizeof(GameResource);
+    if (resources_->cache != cache_) {   // shared from another mode, its mapping stays too
+        bytes += resources_->cache->size();
+    }
+    return bytes;
+}
 
-dpp::emoji GameData::get_emoji(personality::type t) const {
-    assert(t.t < pEffects_.size());
-    const auto& effects = pEffects_[static_cast<size_t>(t.t)];
+dpp::emoji Game_Dataset::get_emoji(personality::type t) const {
+    const auto& all_effects = personality_effects();
+    assert(t.t < all_effects.size());
+    const auto& effects = all_effects[static_cast<size_t>(t.t)];
     if (effects.emoji) {
-        return {effects.emoji->name, effects.emoji->id};
+        return {std::string{effects.emoji->name}, effects.emoji->id};
     }
     return {};
 }
 
-const Good* GameData::get_license_good(int good_type) const {
+const Good* Game_Dataset::get_license_good(int good_type) const {
+    const auto& all_goods = goods();
     size_t idx{static_cast<size_t>(good_type)};
 
-    if (goods_.size() > idx) {
-        return &goods_[idx];
+    if (all_goods.size() > idx) {
+        return &all_goods[idx];
     } else {
-        return &goods_.front();
+        return &all_goods.front();
     }
 }
 
-PIcons GameData::get_icons(const personality::information& info) const {
+std::pair<personality::icon_ref, personality::icon_ref> Game_Dataset::get_icons(
+    const personality::information& info) const {
     typedef personality::type t;
+    const auto& all_goods = goods();
+    const auto& all_effects = personality_effects();
+    const auto good_icon = [](size_t idx) { return static_cast<personality::icon_ref>(idx); };
+    const auto effect_icon = [&all_goods](size_t idx) {
+        return static_cast<personality::icon_ref>(all_goods.size() + idx);
+    };
+
     switch (info.ptype) {
         case t::goods: {
             auto& g_ids = info.goods_id;
             size_t idx0{static_cast<size_t>(g_ids[0])};
             size_t idx1{static_cast<size_t>(g_ids[1])};
-            assert(idx0 < goods_.size() && idx1 < goods_.size() && "Goods index out of bounds");
+            assert(idx0 < all_goods.size() && idx1 < all_goods.size() && "Goods index out of bounds");
 
-            return std::make_pair(&goods_[idx0].icon_url, &goods_[idx1 ? idx1 : idx0].icon_url);
+            return std::make_pair(good_icon(idx0), good_icon(idx1 ? idx1 : idx0));
         }
         case t::hourly: {
-            const GameResource* res = nullptr;
+            personality::icon_ref res = personality::s_no_icon;
             const auto find_money = [](const GameResource& g) { return g.name == "Money"; };
             const auto find_prestige = [](const GameResource& g) { return g.name == "Hourly prestige"; };
 
             switch (info.goods_id[0]) {
                 case 0: {
-                    auto money = std::find_if(goods_.begin(), goods_.end(), find_money);
-                    if (money != goods_.end()) {
-                        res = &(*money);
+                    auto money = std::find_if(all_goods.begin(), all_goods.end(), find_money);
+                    if (money != all_goods.end()) {
+                        res = good_icon(money - all_goods.begin());
                     }
                     break;
                 }
                 case 2: {
-                    auto prestige = std::find_if(pEffects_.begin(), pEffects_.end(), find_prestige);
-                    if (prestige != pEffects_.end()) {
-                        res = &(*prestige);
+                    auto prestige = std::find_if(all_effects.begin(), all_effects.end(), find_prestige);
+                    if (prestige != all_effects.end()) {
+                        res = effect_icon(prestige - all_effects.begin());
                     }
                     break;
                 }
@@ -218,34 +391,281 @@ PIcons GameData::get_icons(const personality::information& info) const {
                     logger->warn("No hourly personality found with value {}", info.goods_id[0]);
                 }
             }
-            if (!res) {
+            if (res == personality::s_no_icon) {
                 logger->warn("No resource of hourly personality with id {} found", info.id);
-                return std::make_pair(&err_icon_, &err_icon_);
             }
 
-            return std::make_pair(&res->icon_url, &res->icon_url);
+            return std::make_pair(res, res);
         }
         default: {
-            assert(info.ptype.t < pEffects_.size() && "pEffects index out of bounds");
-            auto&& icon = &pEffects_[info.ptype.t].icon_url;
+            assert(info.ptype.t < all_effects.size() && "pEffects index out of bounds");
+            auto icon = effect_icon(info.ptype.t);
             return std::make_pair(icon, icon);
         }
     }
 }
 
-void from_json(const nlohmann::json& j, GameResource& gr) {
+void gdcache::from_json(const nlohmann::json& j, Resource_Entry& e) {
     const auto emoji_id = "emoji-id";
     const auto emoji_name = "emoji";
 
-    gr.id = j.at("id");
-    gr.name = j.at("name");
-    gr.icon_url = j.at("icon");
+    e.id = j.at("id");
+    e.name = j.at("name");
+    e.icon_url = j.at("icon");
 
     if (j.contains(emoji_id) && j.contains(emoji_name)) {
-        gr.emoji = {j.at(emoji_id), j.at(emoji_name)};
+        e.emoji = {j.at(emoji_id).get<uint64_t>(), j.at(emoji_name).get<std::string>()};
+    }
+}
+
+/// ---------------------------------------- Resource_Pool ---------------------------------------
+#pragma region Resource_Pool
+
+std::shared_ptr<const Resource_Set> Resource_Pool::intern(std::shared_ptr<const GameData_Cache> cache) {
+    const auto each_record = [&cache](auto f) {
+        for (uint32_t i = 0; i < cache->goods_count(); ++i) {
+            f(cache->goods()[i]);
+        }
+        for (uint32_t i = 0; i < cache->effects_count(); ++i) {
+            f(cache->effects()[i]);
+        }
+    };
+
+    // the key holds every field, equal keys mean equal sets
+    std::string key;
+    each_record([&](const gdcache::Resource_Record& r) {
+        key.append(std::to_string(r.id)).append(1, '\0');
+        key.append(cache->str(r.name)).append(1, '\0').append(cache->str(r.icon_url)).append(1, '\0');
+        if (r.has_emoji) {
+            key.append(std::to_string(r.emoji_id)).append(1, '\0').append(cache->str(r.emoji_name));
+        }
+        key.append(1, '\n');
+    });
+    key.append(std::to_string(cache->goods_count()));
+
+    std::lock_guard<std::mutex> lock{mtx_};
+    for (auto it = sets_.begin(); it != sets_.end();) {
+        it = it->second.expired() ? sets_.erase(it) : std::next(it);
+    }
+
+    if (auto found = sets_.find(key); found != sets_.end()) {
+        if (auto shared = found->second.lock()) {
+            logger->debug("Sharing {} gamedata resources with a loaded game mode",
+                          cache->goods_count() + cache->effects_count());
+            return shared;
+        }
+    }
+
+    auto set = std::make_shared<Resource_Set>();
+    set->goods.reserve(cache->goods_count());
+    set->effects.reserve(cache->effects_count());
+    uint32_t record = 0;
+    each_record([&](const gdcache::Resource_Record& r) {
+        auto& resources = record++ < cache->goods_count() ? set->goods : set->effects;
+        auto& added = resources.emplace_back(GameResource{r.id, cache->str(r.name), cache->str(r.icon_url), {}});
+        if (r.has_emoji) {
+            added.emoji = GameIconEmoji{r.emoji_id, cache->str(r.emoji_name)};
+        }
+    });
+    set->cache = std::move(cache);
+
+    sets_.emplace(std::move(key), set);
+    return set;
+}
+
+#pragma endregion Resource_Pool
+
+/// ---------------------------------------- GameData ---------------------------------------
+#pragma region GameData
+
+namespace {
+
+// Tells whether any of the gamedata sources changed since the last call
+class Source_Watcher {
+  public:
+    explicit Source_Watcher(std::vector<std::string> sources) : sources_(std::move(sources)) {
+#ifdef GAMEDATA_USE_INOTIFY
+        fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        const std::string dir = fs::path{sources_.front()}.parent_path().string();
+        if (fd_ >= 0 && ::inotify_add_watch(fd_, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+        if (fd_ < 0) {
+            logger->warn("Could not watch {}, polling the gamedata files instead", dir);
+        }
+#endif
+        mtimes_ = mtimes();
+    }
+
+    Source_Watcher(const Source_Watcher&) = delete;
+    Source_Watcher& operator=(const Source_Watcher&) = delete;
+
+    ~Source_Watcher() {
+#ifdef GAMEDATA_USE_INOTIFY
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+#endif
+    }
+
+    bool changed() {
+#ifdef GAMEDATA_USE_INOTIFY
+        if (fd_ >= 0) {
+            return read_events();
+        }
+#endif
+        auto now = steady_clock::now();
+        if (now < next_poll_) {
+            return false;
+        }
+        next_poll_ = now + GameData::s_poll_interval;
+
+        auto current = mtimes();
+        bool changed = current != mtimes_;
+        mtimes_ = std::move(current);
+        return changed;
+    }
+
+  private:
+    std::vector<fs::file_time_type> mtimes() const {
+        std::vector<fs::file_time_type> times;
+        for (const auto& source : sources_) {
+            std::error_code ec;
+            times.push_back(fs::last_write_time(source, ec));
+        }
+        return times;
+    }
+
+#ifdef GAMEDATA_USE_INOTIFY
+    bool read_events() {
+        // the cache is written to the same directory, only the sources count
+        const auto is_source = [this](const char* name) {
+            return std::any_of(sources_.begin(), sources_.end(),
+                               [name](const std::string& s) { return fs::path{s}.filename() == name; });
+        };
+
+        bool changed = false;
+        alignas(inotify_event) char buf[4096];
+        ssize_t len;
+        while ((len = ::read(fd_, buf, sizeof(buf))) > 0) {
+            for (char* at = buf; at < buf + len;) {
+                const auto* event = reinterpret_cast<const inotify_event*>(at);
+                if (event->len && is_source(event->name)) {
+                    changed = true;
+                }
+                at += sizeof(inotify_event) + event->len;
+            }
+        }
+        return changed;
+    }
+
+    int fd_{-1};
+#endif
+
+    std::vector<std::string> sources_;
+    std::vector<fs::file_time_type> mtimes_;
+    steady_clock::time_point next_poll_{};
+};
+
+}   // namespace
+
+GameData::~GameData() { stop(); }
+
+void GameData::init(const std::string& game_mode, Resource_Pool* pool) {
+    game_mode_ = game_mode;
+    pool_ = pool;
+    current_.store(Game_Dataset::load(game_mode, pool));
+    last_reload_ = steady_clock::now();
+
+    watching_ = true;
+    watch_thread_ = std::thread{&GameData::watch, this};
+}
+
+void GameData::stop() {
+    {
+        std::lock_guard<std::mutex> lock{mtx_};
+        watching_ = false;
+    }
+    cv_.notify_all();
+
+    if (watch_thread_.joinable()) {
+        watch_thread_.join();
+    }
+}
+
+Personality_Ptr GameData::get_personality(int id) {
+    Dataset_Ptr data = snapshot();
+    if (const personality* p = data->find_personality(id)) {
+        return Personality_Ptr{data, p};
+    }
+
+    logger->warn("Unknown personality id {}, refreshing the gamedata", id);
+    request_refresh();
+    return {};
+}
+
+void GameData::request_refresh() {
+    {
+        std::lock_guard<std::mutex> lock{mtx_};
+        refresh_requested_ = true;
+    }
+    cv_.notify_all();
+}
+
+void GameData::watch() {
+    Source_Watcher sources{Game_Dataset::sources(game_mode_)};
+    std::optional<steady_clock::time_point> changed_at;
+
+    while (watching_) {
+        bool requested;
+        {
+            std::unique_lock<std::mutex> lock{mtx_};
+            cv_.wait_for(lock, seconds{1}, [this]() { return !watching_ || refresh_requested_; });
+            requested = std::exchange(refresh_requested_, false);
+        }
+
+        if (!watching_) {
+            break;
+        }
+
+        if (requested) {
+            reload(false);
+        }
+
+        // every new change restarts the settle time, a copy writes the files one by one
+        const auto now = steady_clock::now();
+        if (sources.changed()) {
+            changed_at = now;
+        }
+
+        if (changed_at && now - *changed_at >= s_settle_time) {
+            changed_at.reset();
+            reload(true);
+        }
+    }
+}
+
+bool GameData::reload(bool forced) {
+    std::lock_guard<std::mutex> lock{reload_mtx_};
+    const auto now = steady_clock::now();
+    if (!forced && now - last_reload_ < s_min_refresh_interval) {
+        return false;
+    }
+    last_reload_ = now;
+
+    try {
+        Dataset_Ptr data = Game_Dataset::load(game_mode_, pool_);
+        logger->info("Reloaded gamedata {}: {} -> {} personalities", game_mode_, snapshot()->personality_count(),
+                     data->personality_count());
+        current_.store(std::move(data));
+        return true;
+    } catch (const std::exception& e) {
+        logger->error("Gamedata reload failed, keeping the current data: {}", e.what());
     }
+    return false;
 }
 
-void to_json(nlohmann::json&, const GameResource&) {}
+#pragma endregion GameData
 
 }   // namespace railcord
@@ -1,29 +1,37 @@
 #ifndef GAMEDATA_H
 #define GAMEDATA_H
 
-#include <deque>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <unordered_map>
-#include <utility>
+#include <vector>
 
 #include <dpp/dpp.h>
 
+#include "gamedata_cache.h"
 #include "personality.h"
 
 namespace railcord {
 
-using PIcons = std::pair<const std::string*, const std::string*>;
-using GameIconUrl = std::string;
+using GameIconUrl = std::string_view;
 
+// Strings are views into the gamedata cache
 struct GameIconEmoji {
     std::uint64_t id;
-    std::string name;
+    std::string_view name;
 };
 
 struct GameResource {
     int id;
-    std::string name;
+    std::string_view name;
     GameIconUrl icon_url;
     std::optional<GameIconEmoji> emoji;
 };
@@ -31,29 +39,135 @@ struct GameResource {
 using Good = GameResource;
 using PersonalityEffect = GameResource;
 
-void from_json(const nlohmann::json& j, GameResource& gr);
-void to_json(nlohmann::json& j, const GameResource& gr);
+// Goods and personality effects of a game mode. The strings are views into the cache they were read from, which
+// the set keeps mapped so modes with identical resources can share one
+struct Resource_Set {
+    std::vector<Good> goods;
+    std::vector<PersonalityEffect> effects;
+    std::shared_ptr<const GameData_Cache> cache;
+};
 
-class GameData {
+// Hands out one Resource_Set for every distinct set of resources still in use
+class Resource_Pool {
+  public:
+    std::shared_ptr<const Resource_Set> intern(std::shared_ptr<const GameData_Cache> cache);
+
+  private:
+    std::mutex mtx_;
+    std::unordered_map<std::string, std::weak_ptr<const Resource_Set>> sets_;   // keyed by the serialized records
+};
+
+// One immutable version of the game resources. Personalities point back into it for their strings and icons,
+// so it is only handed out through a shared_ptr and never moved
+class Game_Dataset {
   public:
-    void init(const std::string& game_mode = "classic");
+    Game_Dataset(const Game_Dataset&) = delete;
+    Game_Dataset& operator=(const Game_Dataset&) = delete;
 
-    const personality& get_personality(int id) const;
+    // Resources are shared through pool when one is given
+    static std::shared_ptr<const Game_Dataset> load(const std::string& game_mode, Resource_Pool* pool = nullptr);
+    static std::vector<std::string> sources(const std::string& game_mode);
+
+    const personality* find_personality(int id) const;   // nullptr if the id is unknown
+    const personality& unknown_personality() const { return unknow_; }
     const personality& get_rnd_personality(personality::type t) const;
 
-    const std::deque<Good>& goods() const;
-    const std::deque<Good>& personality_effects() const;
+    // Personalities are stored densely sorted by id
+    const personality& personality_at(uint32_t idx) const { return personalities_[idx]; }
+    size_t personality_count() const { return personalities_.size(); }
+
+    // Indices of all personalities of a type sorted by effect, then id
+    const std::vector<uint32_t>& personalities_of_type(personality::type t) const;
+
+    const std::vector<Good>& goods() const { return resources_->goods; }
+    const std::vector<PersonalityEffect>& personality_effects() const { return resources_->effects; }
     const Good* get_license_good(int good_type) const;
 
     dpp::emoji get_emoji(personality::type t) const;
 
+    std::string_view str(uint32_t ref) const { return cache_->str(ref); }
+
+    // Goods come first in the icon numbering, then the personality effects
+    GameIconUrl icon(personality::icon_ref ref) const;
+
+    // Built once per personality of this dataset: the worker art url and an embed missing only the auction times
+    std::string_view art_url(const personality& p) const { return renders_[render_index(p)].art_url; }
+    const dpp::embed& embed_template(const personality& p) const { return renders_[render_index(p)].embed; }
+
+    // Approximate bytes held by this version, shared resources included
+    size_t memory_usage() const;
+
+    static constexpr uint32_t s_no_index = UINT32_MAX;
+    static constexpr int s_max_flat_id = 1 << 16;   // sparser ids fall back to a binary search
+
   private:
-    PIcons get_icons(const personality::information& info) const;
+    Game_Dataset() = default;
+    void load_cache(Resource_Pool* pool);
+    void build_indices();
+    void build_renders();
+    size_t render_index(const personality& p) const;   // the unknown personality is rendered last
+    std::pair<personality::icon_ref, personality::icon_ref> get_icons(const personality::information& info) const;
+
+    std::shared_ptr<const GameData_Cache> cache_;   // string arena of every personality and resource
     personality unknow_;
-    GameIconUrl err_icon_;
-    std::unordered_map<int, personality> personalities_;
-    std::deque<Good> goods_;
-    std::deque<PersonalityEffect> pEffects_;
+    std::vector<personality> personalities_;
+    std::vector<uint32_t> id_index_;   // id -> index into personalities_, empty when ids are too sparse
+    std::array<std::vector<uint32_t>, personality::type::unknown + 1> by_type_;
+    std::shared_ptr<const Resource_Set> resources_;
+
+    struct Render {
+        std::string art_url;
+        dpp::embed embed;
+    };
+    std::vector<Render> renders_;   // parallel to personalities_
+};
+
+using Dataset_Ptr = std::shared_ptr<const Game_Dataset>;
+using Personality_Ptr = std::shared_ptr<const personality>;   // keeps its dataset alive
+
+// The current game resources. The resource files are watched (inotify on linux, mtime polling elsewhere) and a
+// changed file rebuilds the dataset in the background, published with an atomic pointer swap. Readers keep the
+// snapshot they took, an older version lives until its last reader drops it
+class GameData {
+  public:
+    GameData() = default;
+    GameData(const GameData&) = delete;
+    GameData& operator=(const GameData&) = delete;
+    ~GameData();
+
+    // Loads and starts watching, throws if the mode can't be loaded
+    void init(const std::string& game_mode = "classic", Resource_Pool* pool = nullptr);
+    void stop();
+
+    Dataset_Ptr snapshot() const { return current_.load(); }
+    const std::string& game_mode() const { return game_mode_; }
+
+    // Null for an unknown id, which requests a refresh since the game may have added it
+    Personality_Ptr get_personality(int id);
+
+    // Wakes the watch thread to rebuild from the resource files, at most once every s_min_refresh_interval. Never
+    // blocks
+    void request_refresh();
+
+    static constexpr std::chrono::seconds s_min_refresh_interval{60};
+    static constexpr std::chrono::seconds s_settle_time{2};   // let a copy finish before rebuilding
+    static constexpr std::chrono::seconds s_poll_interval{5};
+
+  private:
+    void watch();
+    bool reload(bool forced);
+
+    std::string game_mode_;
+    Resource_Pool* pool_{nullptr};
+    std::atomic<Dataset_Ptr> current_;
+
+    std::thread watch_thread_;
+    std::atomic_bool watching_{false};
+    bool refresh_requested_{false};   // guarded by mtx_
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::mutex reload_mtx_;   // one rebuild at a time
+    std::chrono::steady_clock::time_point last_reload_;
 };
 
 }   // namespace railcord
@@ -0,0 +1,362 @@
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define GAMEDATA_USE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <fmt/format.h>
+
+#include "gamedata_cache.h"
+#include "logger.h"
+
+namespace railcord {
+
+using namespace gdcache;
+namespace fs = std::filesystem;
+
+static_assert(std::is_trivially_copyable_v<Header>);
+static_assert(std::is_trivially_copyable_v<Personality_Record>);
+static_assert(std::is_trivially_copyable_v<Resource_Record>);
+
+/// ---------------------------------------- Mapped_File ---------------------------------------
+#pragma region Mapped_File
+
+Mapped_File::Mapped_File(Mapped_File&& other) noexcept { *this = std::move(other); }
+
+Mapped_File& Mapped_File::operator=(Mapped_File&& other) noexcept {
+    if (this != &other) {
+        release();
+        mapped_ = other.mapped_;
+        size_ = other.size_;
+        buffer_ = std::move(other.buffer_);
+        data_ = mapped_ ? other.data_ : buffer_.data();   // moving may invalidate small buffers
+
+        other.data_ = nullptr;
+        other.size_ = 0;
+        other.mapped_ = false;
+    }
+    return *this;
+}
+
+Mapped_File::~Mapped_File() { release(); }
+
+Mapped_File Mapped_File::map(const std::string& path) {
+#ifdef GAMEDATA_USE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error{fmt::format("Could not open {}", path)};
+    }
+
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error{fmt::format("Could not stat {}", path)};
+    }
+
+    Mapped_File f;
+    f.size_ = static_cast<size_t>(st.st_size);
+    if (f.size_ > 0) {
+        void* addr = ::mmap(nullptr, f.size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error{fmt::format("Could not map {}", path)};
+        }
+        f.data_ = static_cast<const char*>(addr);
+        f.mapped_ = true;
+    }
+
+    ::close(fd);
+    return f;
+#else
+    std::ifstream stream{path, std::ios::binary};
+    if (!stream.is_open()) {
+        throw std::runtime_error{fmt::format("Could not open {}", path)};
+    }
+    return from_buffer(std::string((std::istreambuf_iterator<char>{stream}), std::istreambuf_iterator<char>{}));
+#endif
+}
+
+Mapped_File Mapped_File::from_buffer(std::string buffer) {
+    Mapped_File f;
+    f.buffer_ = std::move(buffer);
+    f.data_ = f.buffer_.data();
+    f.size_ = f.buffer_.size();
+    return f;
+}
+
+void Mapped_File::release() {
+#ifdef GAMEDATA_USE_MMAP
+    if (mapped_ && data_) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+    data_ = nullptr;
+    size_ = 0;
+    mapped_ = false;
+    buffer_.clear();
+}
+
+#pragma endregion Mapped_File
+
+/// ---------------------------------------- GameData_Cache ---------------------------------------
+#pragma region GameData_Cache
+
+static uint64_t fnv1a(std::string_view bytes) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : bytes) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static Source_Stamp quick_stamp(const std::string& path) {
+    Source_Stamp stamp{};
+    stamp.mtime = static_cast<int64_t>(fs::last_write_time(path).time_since_epoch().count());
+    stamp.size = static_cast<uint64_t>(fs::file_size(path));
+    return stamp;
+}
+
+static Source_Stamp full_stamp(const std::string& path) {
+    Source_Stamp stamp = quick_stamp(path);
+    stamp.hash = fnv1a(Mapped_File::map(path).view());
+    return stamp;
+}
+
+static constexpr uint32_t align8(size_t n) { return static_cast<uint32_t>((n + 7) & ~size_t{7}); }
+
+std::optional<GameData_Cache> GameData_Cache::open(const std::string& path, const std::vector<std::string>& sources) {
+    if (!fs::exists(path)) {
+        logger->info("No gamedata cache at {}", path);
+        return {};
+    }
+
+    try {
+        GameData_Cache cache{Mapped_File::map(path)};
+        if (!cache.is_valid() || cache.header().source_count != sources.size()) {
+            logger->warn("Gamedata cache {} is corrupt or from another version", path);
+            return {};
+        }
+
+        for (size_t i = 0; i < sources.size(); ++i) {
+            const Source_Stamp& cached = cache.header().sources[i];
+            Source_Stamp current = quick_stamp(sources[i]);
+            if (cached.mtime == current.mtime && cached.size == current.size) {
+                continue;
+            }
+
+            // touched or copied, only a content change invalidates the cache
+            if (cached.size != current.size || cached.hash != full_stamp(sources[i]).hash) {
+                logger->info("Gamedata source {} changed", sources[i]);
+                return {};
+            }
+        }
+
+        return cache;
+    } catch (const std::exception& e) {
+        logger->warn("Failed to open gamedata cache {}: {}", path, e.what());
+        return {};
+    }
+}
+
+std::vector<Source_Stamp> GameData_Cache::stamp(const std::vector<std::string>& sources) {
+    std::vector<Source_Stamp> stamps;
+    stamps.reserve(sources.size());
+    for (const auto& source : sources) {
+        stamps.push_back(full_stamp(source));
+    }
+    return stamps;
+}
+
+GameData_Cache GameData_Cache::create(const std::string& path, const std::vector<Source_Stamp>& stamps,
+                                      const Contents& contents) {
+    if (stamps.size() > s_max_sources) {
+        throw std::invalid_argument{"Too many gamedata cache sources"};
+    }
+
+    std::string strings;
+    std::unordered_map<std::string_view, Str_Ref> interned;
+    std::deque<std::string> owned;   // keys of interned, stable on growth
+    const auto intern = [&](const std::string& s) -> Str_Ref {
+        if (auto found = interned.find(s); found != interned.end()) {
+            return found->second;
+        }
+
+        Str_Ref ref = static_cast<uint32_t>(strings.size());
+        const auto size = static_cast<uint32_t>(s.size());
+        strings.append(reinterpret_cast<const char*>(&size), sizeof(size)).append(s);
+        interned.emplace(owned.emplace_back(s), ref);
+        return ref;
+    };
+
+    std::vector<Personality_Record> personalities;
+    personalities.reserve(contents.personalities.size());
+    for (const auto& p : contents.personalities) {
+        Personality_Record r{};
+        r.id = p.info.id;
+        r.effect = p.info.effect;
+        r.art_id = p.info.art_id;
+        r.goods_id[0] = p.info.goods_id[0];
+        r.goods_id[1] = p.info.goods_id[1];
+        r.type = p.info.ptype.t;
+        r.name = intern(p.name);
+        r.description = intern(p.description);
+        personalities.push_back(r);
+    }
+
+    const auto resources = [&](const std::vector<Resource_Entry>& entries) {
+        std::vector<Resource_Record> records;
+        records.reserve(entries.size());
+        for (const auto& e : entries) {
+            Resource_Record r{};
+            r.id = e.id;
+            r.name = intern(e.name);
+            r.icon_url = intern(e.icon_url);
+            if (e.emoji) {
+                r.has_emoji = 1;
+                r.emoji_id = e.emoji->first;
+                r.emoji_name = intern(e.emoji->second);
+            }
+            records.push_back(r);
+        }
+        return records;
+    };
+    std::vector<Resource_Record> goods = resources(contents.goods);
+    std::vector<Resource_Record> effects = resources(contents.effects);
+
+    Header header{};
+    std::memcpy(header.magic, s_magic, sizeof(s_magic));
+    header.version = s_version;
+    header.source_count = static_cast<uint32_t>(stamps.size());
+    std::copy(stamps.begin(), stamps.end(), header.sources);
+
+    header.personality_count = static_cast<uint32_t>(personalities.size());
+    header.personality_offset = align8(sizeof(Header));
+    header.goods_count = static_cast<uint32_t>(goods.size());
+    header.goods_offset = align8(header.personality_offset + personalities.size() * sizeof(Personality_Record));
+    header.effects_count = static_cast<uint32_t>(effects.size());
+    header.effects_offset = align8(header.goods_offset + goods.size() * sizeof(Resource_Record));
+    header.strings_offset = align8(header.effects_offset + effects.size() * sizeof(Resource_Record));
+    header.unknown_name = intern(contents.unknown_name);
+    header.unknown_description = intern(contents.unknown_description);
+    header.strings_size = static_cast<uint32_t>(strings.size());
+
+    std::string buffer(header.strings_offset + strings.size(), '\0');
+    const auto write = [&buffer](uint32_t offset, const void* src, size_t n) {
+        if (n) {
+            std::memcpy(&buffer[offset], src, n);
+        }
+    };
+    write(0, &header, sizeof(header));
+    write(header.personality_offset, personalities.data(), personalities.size() * sizeof(Personality_Record));
+    write(header.goods_offset, goods.data(), goods.size() * sizeof(Resource_Record));
+    write(header.effects_offset, effects.data(), effects.size() * sizeof(Resource_Record));
+    write(header.strings_offset, strings.data(), strings.size());
+
+    // write then rename, a reader never sees a partial cache
+    const std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream out{tmp_path, std::ios::binary | std::ios::trunc};
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        if (!out) {
+            logger->warn("Could not write gamedata cache {}, keeping it in memory", path);
+            return GameData_Cache{Mapped_File::from_buffer(std::move(buffer))};
+        }
+    }
+
+    std::error_code ec;
+    fs::rename(tmp_path, path, ec);
+    if (ec) {
+        logger->warn("Could not replace gamedata cache {}: {}, keeping it in memory", path, ec.message());
+        return GameData_Cache{Mapped_File::from_buffer(std::move(buffer))};
+    }
+
+    logger->info("Wrote gamedata cache {} ({} bytes, {} strings)", path, buffer.size(), interned.size());
+    return GameData_Cache{Mapped_File::map(path)};
+}
+
+const Personality_Record* GameData_Cache::personalities() const {
+    return reinterpret_cast<const Personality_Record*>(file_.data() + header().personality_offset);
+}
+
+const Resource_Record* GameData_Cache::goods() const {
+    return reinterpret_cast<const Resource_Record*>(file_.data() + header().goods_offset);
+}
+
+const Resource_Record* GameData_Cache::effects() const {
+    return reinterpret_cast<const Resource_Record*>(file_.data() + header().effects_offset);
+}
+
+std::string_view GameData_Cache::str(Str_Ref ref) const {
+    const char* at = file_.data() + header().strings_offset + ref;
+    uint32_t size;
+    std::memcpy(&size, at, sizeof(size));
+    return {at + sizeof(size), size};
+}
+
+const Header& GameData_Cache::header() const { return *reinterpret_cast<const Header*>(file_.data()); }
+
+bool GameData_Cache::is_valid() const {
+    if (file_.size() < sizeof(Header)) {
+        return false;
+    }
+
+    const Header& h = header();
+    if (std::memcmp(h.magic, s_magic, sizeof(s_magic)) != 0 || h.version != s_version ||
+        h.source_count > s_max_sources) {
+        return false;
+    }
+
+    const auto fits = [size = file_.size()](uint64_t offset, uint64_t bytes) { return offset + bytes <= size; };
+    if (!fits(h.personality_offset, uint64_t{h.personality_count} * sizeof(Personality_Record)) ||
+        !fits(h.goods_offset, uint64_t{h.goods_count} * sizeof(Resource_Record)) ||
+        !fits(h.effects_offset, uint64_t{h.effects_count} * sizeof(Resource_Record)) ||
+        !fits(h.strings_offset, h.strings_size)) {
+        return false;
+    }
+
+    const auto str_fits = [this, &h](Str_Ref r) {
+        if (uint64_t{r} + sizeof(uint32_t) > h.strings_size) {
+            return false;
+        }
+        uint32_t size;
+        std::memcpy(&size, file_.data() + h.strings_offset + r, sizeof(size));
+        return uint64_t{r} + sizeof(size) + size <= h.strings_size;
+    };
+    if (!str_fits(h.unknown_name) || !str_fits(h.unknown_description)) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < h.personality_count; ++i) {
+        const auto& p = personalities()[i];
+        if (!str_fits(p.name) || !str_fits(p.description)) {
+            return false;
+        }
+    }
+
+    const auto resources_fit = [&](const Resource_Record* records, uint32_t count) {
+        for (uint32_t i = 0; i < count; ++i) {
+            if (!str_fits(records[i].name) || !str_fits(records[i].icon_url) || !str_fits(records[i].emoji_name)) {
+                return false;
+            }
+        }
+        return true;
+    };
+    return resources_fit(goods(), h.goods_count) && resources_fit(effects(), h.effects_count);
+}
+
+#pragma endregion GameData_Cache
+
+}   // namespace railcord
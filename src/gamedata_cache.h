@@ -0,0 +1,163 @@
+#ifndef GAMEDATA_CACHE_H
+#define GAMEDATA_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "personality.h"
+
+namespace railcord {
+
+// Read only bytes of a file, memory mapped where the platform allows it
+class Mapped_File {
+  public:
+    Mapped_File() = default;
+    Mapped_File(const Mapped_File&) = delete;
+    Mapped_File& operator=(const Mapped_File&) = delete;
+    Mapped_File(Mapped_File&& other) noexcept;
+    Mapped_File& operator=(Mapped_File&& other) noexcept;
+    ~Mapped_File();
+
+    static Mapped_File map(const std::string& path);   // throws std::runtime_error
+    static Mapped_File from_buffer(std::string buffer);
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+    std::string_view view() const { return {data_, size_}; }
+
+  private:
+    void release();
+
+    const char* data_{nullptr};
+    size_t size_{0};
+    bool mapped_{false};
+    std::string buffer_;
+};
+
+namespace gdcache {
+
+inline constexpr char s_magic[8]{'L', 'U', 'C', 'Y', 'G', 'D', 'C', '\0'};
+inline constexpr uint32_t s_version = 3;   // bump whenever the layout or the way records are built changes
+inline constexpr uint32_t s_max_sources = 4;
+
+// Offset of a string in the string table, stored as a uint32_t length followed by the bytes
+using Str_Ref = uint32_t;
+
+struct Source_Stamp {
+    int64_t mtime;
+    uint64_t size;
+    uint64_t hash;
+};
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t source_count;
+    Source_Stamp sources[s_max_sources];
+    uint32_t personality_count;
+    uint32_t personality_offset;
+    uint32_t goods_count;
+    uint32_t goods_offset;
+    uint32_t effects_count;
+    uint32_t effects_offset;
+    uint32_t strings_offset;
+    uint32_t strings_size;
+    Str_Ref unknown_name;
+    Str_Ref unknown_description;
+};
+
+struct Personality_Record {
+    int32_t id;
+    int32_t effect;
+    int32_t art_id;
+    int32_t goods_id[2];
+    uint8_t type;
+    uint8_t pad[3];
+    Str_Ref name;
+    Str_Ref description;
+};
+
+struct Resource_Record {
+    int32_t id;
+    uint32_t has_emoji;
+    uint64_t emoji_id;
+    Str_Ref name;
+    Str_Ref icon_url;
+    Str_Ref emoji_name;
+    uint32_t pad;
+};
+
+// Parsed source data a cache is built from
+struct Resource_Entry {
+    int id;
+    std::string name;
+    std::string icon_url;
+    std::optional<std::pair<uint64_t, std::string>> emoji;
+};
+
+struct Personality_Entry {
+    personality::information info;
+    std::string name;
+    std::string description;
+};
+
+void from_json(const nlohmann::json& j, Resource_Entry& e);
+
+struct Contents {
+    std::vector<Personality_Entry> personalities;
+    std::vector<Resource_Entry> goods;
+    std::vector<Resource_Entry> effects;
+    std::string unknown_name{"Unkown"};
+    std::string unknown_description{"Unkown personality"};
+};
+
+}   // namespace gdcache
+
+// Flat binary file holding the compiled game data: header, personality and resource records and one string
+// table. It is keyed by the mtime, size and hash of each source file and is used in place once mapped
+class GameData_Cache {
+  public:
+    GameData_Cache() = default;
+
+    // Maps the cache at path, empty if it is missing, corrupt or older than any of the sources
+    static std::optional<GameData_Cache> open(const std::string& path, const std::vector<std::string>& sources);
+
+    // Stamps the sources, taken before they are parsed so an edit made while building invalidates the cache
+    static std::vector<gdcache::Source_Stamp> stamp(const std::vector<std::string>& sources);
+
+    // Writes a cache for contents built from the stamped sources and maps it, the cache is kept in memory if it
+    // can't be written
+    static GameData_Cache create(const std::string& path, const std::vector<gdcache::Source_Stamp>& stamps,
+                                 const gdcache::Contents& contents);
+
+    const gdcache::Personality_Record* personalities() const;
+    uint32_t personality_count() const { return header().personality_count; }
+
+    const gdcache::Resource_Record* goods() const;
+    uint32_t goods_count() const { return header().goods_count; }
+
+    const gdcache::Resource_Record* effects() const;
+    uint32_t effects_count() const { return header().effects_count; }
+
+    gdcache::Str_Ref unknown_name() const { return header().unknown_name; }
+    gdcache::Str_Ref unknown_description() const { return header().unknown_description; }
+
+    std::string_view str(gdcache::Str_Ref ref) const;
+    size_t size() const { return file_.size(); }
+
+  private:
+    explicit GameData_Cache(Mapped_File file) : file_(std::move(file)) {}
+    const gdcache::Header& header() const;
+    bool is_valid() const;
+
+    Mapped_File file_;
+};
+
+}   // namespace railcord
+
+#endif   // !GAMEDATA_CACHE_H
@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include "gamedata_registry.h"
+#include "logger.h"
+
+namespace railcord {
+
+using namespace std::chrono;
+
+std::shared_ptr<GameData> GameData_Registry::get(const std::string& game_mode) {
+    // the mode ends up in the resource file names
+    const auto valid_char = [](unsigned char c) { return std::isalnum(c) || c == '_'; };
+    if (game_mode.empty() || !std::all_of(game_mode.begin(), game_mode.end(), valid_char)) {
+        throw std::invalid_argument{fmt::format("Invalid game mode '{}'", game_mode)};
+    }
+
+    std::promise<std::shared_ptr<GameData>> loaded;
+    std::shared_future<std::shared_ptr<GameData>> pending;
+    {
+        std::lock_guard<std::mutex> lock{mtx_};
+        if (auto found = modes_.find(game_mode); found != modes_.end()) {
+            found->second.last_used = steady_clock::now();
+            return found->second.data;
+        }
+
+        if (auto found = loading_.find(game_mode); found != loading_.end()) {
+            pending = found->second;
+        } else {
+            loading_.emplace(game_mode, loaded.get_future().share());
+        }
+    }
+
+    if (pending.valid()) {
+        return pending.get();   // rethrows if that load failed
+    }
+
+    // parsing the sources can take seconds, the other modes stay available meanwhile
+    logger->info("Loading game mode {}", game_mode);
+    std::shared_ptr<GameData> data;
+    try {
+        data = std::make_shared<GameData>();
+        data->init(game_mode, &pool_);
+    } catch (...) {
+        std::lock_guard<std::mutex> lock{mtx_};
+        loading_.erase(game_mode);
+        loaded.set_exception(std::current_exception());
+        throw;
+    }
+
+    std::vector<std::shared_ptr<GameData>> evicted;   // destroyed after the lock is released
+    std::lock_guard<std::mutex> lock{mtx_};
+    loading_.erase(game_mode);
+    modes_.emplace(game_mode, Entry{data, steady_clock::now()});
+    loaded.set_value(data);
+
+    evicted = evict();
+    return data;
+}
+
+void GameData_Registry::set_budget(size_t bytes) {
+    std::vector<std::shared_ptr<GameData>> evicted;   // destroyed after the lock is released
+    std::lock_guard<std::mutex> lock{mtx_};
+    budget_ = bytes;
+    evicted = evict();
+}
+
+size_t GameData_Registry::memory_usage() const {
+    std::lock_guard<std::mutex> lock{mtx_};
+    return usage();
+}
+
+size_t GameData_Registry::usage() const {
+    size_t bytes = 0;
+    for (const auto& [mode, entry] : modes_) {
+        bytes += entry.data->snapshot()->memory_usage();
+    }
+    return bytes;
+}
+
+std::vector<std::shared_ptr<GameData>> GameData_Registry::evict() {
+    std::vector<std::shared_ptr<GameData>> evicted;
+    size_t bytes = usage();
+    while (bytes > budget_) {
+        // only modes the registry alone holds, the caller of get still holds the one just loaded
+        auto oldest = modes_.end();
+        for (auto it = modes_.begin(); it != modes_.end(); ++it) {
+            if (it->second.data.use_count() == 1 &&
+                (oldest == modes_.end() || it->second.last_used < oldest->second.last_used)) {
+                oldest = it;
+            }
+        }
+
+        if (oldest == modes_.end()) {
+            logger->warn("Game modes use {} bytes over a {} bytes budget, all of them are in use", bytes, budget_);
+            break;
+        }
+
+        const size_t freed = oldest->second.data->snapshot()->memory_usage();
+        logger->info("Evicting game mode {}, {} bytes", oldest->first, freed);
+        evicted.push_back(std::move(oldest->second.data));
+        modes_.erase(oldest);
+        bytes -= std::min(bytes, freed);
+    }
+    return evicted;
+}
+
+}   // namespace railcord
@@ -0,0 +1,53 @@
+#ifndef GAMEDATA_REGISTRY_H
+#define GAMEDATA_REGISTRY_H
+
+#include <chrono>
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "gamedata.h"
+
+namespace railcord {
+
+// Game modes loaded on first use, identical resources are shared between them. Once the loaded modes go over
+// the memory budget the least recently used ones nobody holds are evicted
+class GameData_Registry {
+  public:
+    explicit GameData_Registry(size_t budget = s_default_budget) : budget_(budget) {}
+    GameData_Registry(const GameData_Registry&) = delete;
+    GameData_Registry& operator=(const GameData_Registry&) = delete;
+
+    // Loads the mode if needed, throws if it can't be loaded. Holding the pointer keeps the mode loaded. Loading
+    // happens unlocked, callers asking for the same mode meanwhile wait for that load
+    std::shared_ptr<GameData> get(const std::string& game_mode);
+
+    void set_budget(size_t bytes);
+    size_t memory_usage() const;
+
+    static constexpr size_t s_default_budget = 64 * 1024 * 1024;
+
+  private:
+    struct Entry {
+        std::shared_ptr<GameData> data;
+        std::chrono::steady_clock::time_point last_used;
+    };
+
+    // With mtx_ held, the evicted modes are returned so the caller drops them, joining their watchers, unlocked
+    std::vector<std::shared_ptr<GameData>> evict();
+    size_t usage() const;
+
+    mutable std::mutex mtx_;
+    Resource_Pool pool_;   // outlives the modes, declared first
+    std::unordered_map<std::string, Entry> modes_;
+    std::unordered_map<std::string, std::shared_future<std::shared_ptr<GameData>>> loading_;
+    size_t budget_;
+};
+
+}   // namespace railcord
+
+#endif   // !GAMEDATA_REGISTRY_H
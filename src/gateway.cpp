@@ -0,0 +1,102 @@
+#include <array>
+#include <charconv>
+#include <string_view>
+#include <utility>
+
+#include <fmt/format.h>
+#include <INIReader.h>
+
+#include "gateway.h"
+#include "logger.h"
+#include "util.h"
+
+namespace railcord {
+
+// clang-format off
+static constexpr std::array<std::pair<std::string_view, uint32_t>, 21> s_intents{{
+    {"none", 0},
+    {"default", dpp::i_default_intents},
+    {"guilds", dpp::i_guilds},
+    {"guild_members", dpp::i_guild_members},
+    {"guild_bans", dpp::i_guild_bans},
+    {"guild_emojis", dpp::i_guild_emojis},
+    {"guild_integrations", dpp::i_guild_integrations},
+    {"guild_webhooks", dpp::i_guild_webhooks},
+    {"guild_invites", dpp::i_guild_invites},
+    {"guild_voice_states", dpp::i_guild_voice_states},
+    {"guild_presences", dpp::i_guild_presences},
+    {"guild_messages", dpp::i_guild_messages},
+    {"guild_message_reactions", dpp::i_guild_message_reactions},
+    {"guild_message_typing", dpp::i_guild_message_typing},
+    {"direct_messages", dpp::i_direct_messages},
+    {"direct_message_reactions", dpp::i_direct_message_reactions},
+    {"direct_message_typing", dpp::i_direct_message_typing},
+    {"message_content", dpp::i_message_content},
+    {"guild_scheduled_events", dpp::i_guild_scheduled_events},
+    {"auto_moderation_configuration", dpp::i_auto_moderation_configuration},
+    {"auto_moderation_execution", dpp::i_auto_moderation_execution},
+}};
+// clang-format on
+
+// In cache_policy_setting_t order
+static constexpr std::array<std::string_view, 3> s_policies{"aggressive", "lazy", "none"};
+
+static uint32_t parse_intents(std::string_view value) {
+    uint32_t intents{};
+    if (std::from_chars(value.data(), value.data() + value.size(), intents).ec == std::errc{}) {
+        return intents;
+    }
+
+    util::for_each_entry(value, [&intents](std::string_view name) {
+        for (const auto& [n, bits] : s_intents) {
+            if (n == name) {
+                intents |= bits;
+                return;
+            }
+        }
+        logger->warn("Ignoring unknown gateway intent \"{}\"", name);
+    });
+    return intents;
+}
+
+static void parse_policy(const INIReader& settings, const char* key, dpp::cache_policy_setting_t& policy) {
+    const std::string value = settings.Get("Gateway", key, "");
+    if (value.empty()) {
+        return;
+    }
+
+    for (size_t i = 0; i < s_policies.size(); ++i) {
+        if (s_policies[i] == value) {
+            policy = static_cast<dpp::cache_policy_setting_t>(i);
+            return;
+        }
+    }
+    logger->warn("Ignoring {}={}, expected aggressive, lazy or none", key, value);
+}
+
+Gateway_Config Gateway_Config::load(const std::string& settings_file) {
+    Gateway_Config config;
+    INIReader settings{settings_file};
+    if (settings.ParseError()) {
+        return config;   // load_settings reports it
+    }
+
+    if (std::string intents = settings.Get("Gateway", "intents", ""); !intents.empty()) {
+        config.intents = parse_intents(intents);
+    }
+    parse_policy(settings, "cache_users", config.cache.user_policy);
+    parse_policy(settings, "cache_emojis", config.cache.emoji_policy);
+    parse_policy(settings, "cache_roles", config.cache.role_policy);
+    parse_policy(settings, "cache_channels", config.cache.channel_policy);
+    parse_policy(settings, "cache_guilds", config.cache.guild_policy);
+    return config;
+}
+
+std::string Gateway_Config::describe() const {
+    const auto policy = [](dpp::cache_policy_setting_t p) { return s_policies.at(static_cast<size_t>(p)); };
+    return fmt::format("intents {:#x}, cache users:{} emojis:{} roles:{} channels:{} guilds:{}", intents,
+                       policy(cache.user_policy), policy(cache.emoji_policy), policy(cache.role_policy),
+                       policy(cache.channel_policy), policy(cache.guild_policy));
+}
+
+}   // namespace railcord
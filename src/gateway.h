@@ -0,0 +1,33 @@
+#ifndef GATEWAY_H
+#define GATEWAY_H
+
+#include <cstdint>
+#include <string>
+
+#include <dpp/dpp.h>
+
+namespace railcord {
+
+// Interactions and message sends need no intents and Lucy never reads the caches, so by default the gateway only
+// tracks guilds and nothing is cached
+inline constexpr uint32_t s_default_intents = dpp::i_guilds;
+inline constexpr dpp::cache_policy_t s_default_cache_policy{ .user_policy = dpp::cp_none,
+                                                             .emoji_policy = dpp::cp_none,
+                                                             .role_policy = dpp::cp_none,
+                                                             .channel_policy = dpp::cp_none,
+                                                             .guild_policy = dpp::cp_none };
+
+// The [Gateway] section, read before the cluster is built
+struct Gateway_Config {
+    uint32_t intents{s_default_intents};
+    dpp::cache_policy_t cache{s_default_cache_policy};
+
+    // intents is a number or a comma separated list of names (guilds, guild_messages, ..), cache_users,
+    // cache_emojis, cache_roles, cache_channels and cache_guilds are aggressive, lazy or none
+    static Gateway_Config load(const std::string& settings_file);
+    std::string describe() const;
+};
+
+}   // namespace railcord
+
+#endif   // !GATEWAY_H
@@ -1,4 +1,6 @@
 #include <algorithm>
+#include <filesystem>
+#include <fstream>
 
 #include <cpr/cpr.h>
 #include <dpp/nlohmann/json.hpp>
@@ -6,6 +8,7 @@
 #include "license.h"
 #include "logger.h"
 #include "lucyapi.h"
+#include "metrics.h"
 #include "util.h"
 
 namespace railcord {
@@ -28,12 +31,30 @@ void from_json(const nlohmann::json& j, License& l) {
     l.good_type = j.at("ResourceType");
 }
 
-void to_json(nlohmann::json&, const License&) {}
+void to_json(nlohmann::json& j, const License& l) {
+    j = json{{"AuctionId", l.id},
+             {"StartTime", l.start.count()},
+             {"EndTime", l.end.count()},
+             {"LicenceCount", l.count},
+             {"MinimumPrice", l.min_price},
+             {"ResourceType", l.good_type}};
+}
 
 static std::deque<License> request_licenses() {
-    auto response = util::request(api_endpoints.at(api::license_id), s_request_license_timeout);
+    // not tied to a world, the empty label keeps the families' label names the same
+    static Histogram& s_request = metrics.histogram("lucy_http_request_seconds", "Latency of the game API requests",
+                                                    {{"endpoint", "license"}, {"world", ""}});
+    static Histogram& s_parse = metrics.histogram("lucy_parse_seconds", "Time to decode the game API responses",
+                                                  {{"payload", "licenses"}, {"world", ""}});
+
+    std::string response;
+    {
+        Scoped_Timer timing{s_request};
+        response = util::request(api_endpoints.at(api::license_id), s_request_license_timeout);
+    }
 
     try {
+        Scoped_Timer timing{s_parse};
         return json::parse(response).at("Body").get<std::deque<License>>();
     } catch (const json::exception& e) {
         logger->warn("Parsing license json failed with: {}", e.what());
@@ -44,37 +65,125 @@ static std::deque<License> request_licenses() {
     return {};
 }
 
-void License_Manager::fetch_new_licenses() {
+License_Manager::~License_Manager() { stop(); }
+
+void License_Manager::start() {
+    std::lock_guard<std::mutex> lock{refresh_mtx_};
+    if (!running_.load()) {
+        running_.store(true);
+        refresh_thread_ = std::thread{&License_Manager::refresher, this};
+    }
+}
+
+void License_Manager::stop() {
+    {
+        std::lock_guard<std::mutex> lock{refresh_mtx_};
+        running_.store(false);
+    }
+    cv_.notify_one();
+
+    if (refresh_thread_.joinable()) {
+        refresh_thread_.join();
+    }
+}
+
+void License_Manager::request_refresh() {
+    {
+        std::lock_guard<std::mutex> lock{refresh_mtx_};
+        refresh_requested_ = true;
+    }
+    cv_.notify_one();
+}
+
+void License_Manager::refresher() {
+    logger->debug("License refresher started");
+    while (running_.load()) {
+        const seconds wait = refresh() ? duration_cast<seconds>(s_refresh_interval) : s_retry_interval;
+
+        std::unique_lock<std::mutex> lock{refresh_mtx_};
+        cv_.wait_for(lock, wait, [this]() { return !running_.load() || refresh_requested_; });
+        refresh_requested_ = false;
+    }
+    logger->debug("License refresher finished");
+}
+
+bool License_Manager::refresh() { return !needs_fetch() || fetch_new_licenses(); }
+
+bool License_Manager::needs_fetch() {
+    std::lock_guard<std::mutex> lock{mtx_};
+    for (auto& [good_type, queue] : by_good_) {
+        pop_expired(queue);
+    }
+
+    if (licenses_.size() < s_min_licenses) {
+        logger->info("Less than 12hrs ahead of licenses, fetching new licenses");
+        return true;
+    }
+    return false;
+}
+
+bool License_Manager::fetch_new_licenses() {
+    // the request runs unlocked, lookups keep reading the current licenses
     auto request_start = std::chrono::steady_clock::now();
     auto l = request_licenses();
 
     if (l.empty()) {
         logger->warn("Fetch new licenses failed");
-        return;
+        return false;
     }
 
-    t_offset_ = std::chrono::system_clock::now();
     logger->debug("Time taken by license request {:.2f}s",
                   duration_cast<duration<float>>(std::chrono::abs(steady_clock::now() - request_start)).count());
 
-    l.erase(std::remove_if(l.begin(), l.end(), [&](const License& ll) { return ll.start.count() == 0; }), l.end());
+    std::lock_guard<std::mutex> lock{mtx_};
+    merge(std::move(l), std::chrono::system_clock::now());
+    ready_.store(true);
+    return true;
+}
 
-    std::sort(l.begin(), l.end(), [](const License& a, const License& b) { return a.start < b.start; });
+void License_Manager::merge(std::deque<License>&& fetched, system_clock::time_point fetched_at) {
+    if (t_offset_ == system_clock::time_point{}) {
+        t_offset_ = fetched_at;
+    }
+    const auto rebase = duration_cast<seconds>(fetched_at - t_offset_);
 
-    licenses_ = std::move(l);
-}
+    std::unordered_map<int, bool> touched;   // good type -> needs a sort
+    size_t added = 0;
+    for (auto&& license : fetched) {
+        if (license.start.count() == 0) {
+            continue;
+        }
+        license.start += rebase;
+        license.end += rebase;
 
-void License_Manager::update_state() {
-    std::lock_guard<std::mutex> lock{mtx_};
-    if (licenses_.size() < 4 * 12) {   // 12hrs
-        logger->info("Less than 12hrs ahead of licenses, fetching new licenses");
-        fetch_new_licenses();
-        return;
+        auto [it, inserted] = licenses_.try_emplace(license.id, license);
+        if (inserted) {
+            ++added;
+            auto& queue = by_good_[license.good_type];
+            touched[license.good_type] |= !queue.empty() && queue.back()->start > license.start;
+            queue.push_back(&it->second);
+        } else {
+            touched[license.good_type] |= it->second.start != license.start;
+            it->second = std::move(license);
+        }
+    }
+
+    for (auto [good_type, needs_sort] : touched) {
+        if (needs_sort) {
+            auto& queue = by_good_[good_type];
+            std::sort(queue.begin(), queue.end(),
+                      [](const License* a, const License* b) { return a->start < b->start; });
+        }
     }
 
-    licenses_.erase(
-        std::remove_if(licenses_.begin(), licenses_.end(), [&](const License& license) { return expired(license); }),
-        licenses_.end());
+    logger->debug("Merged {} licenses, {} new, {} known", fetched.size(), added, licenses_.size());
+}
+
+void License_Manager::pop_expired(std::deque<License*>& queue) {
+    while (!queue.empty() && expired(*queue.front())) {
+        licenses_.erase(queue.front()->id);
+        queue.pop_front();
+    }
 }
 
 std::chrono::system_clock::time_point License_Manager::get_start_tp(const License& license) {
@@ -98,20 +207,149 @@ bool License_Manager::is_currently_active(const License& license) {
 
 std::optional<License> License_Manager::get_next_license(int good_type) {
     std::lock_guard<std::mutex> lock{mtx_};
-    while (true) {
-        auto found = std::find_if(licenses_.begin(), licenses_.end(), [&](const License& l) {
-            return l.good_type == good_type;
-        });
-        if (found != licenses_.end()) {
-            if (expired(*found)) {
-                licenses_.erase(found);
-            } else {
-                return *found;
+    auto found = by_good_.find(good_type);
+    if (found == by_good_.end()) {
+        return {};
+    }
+
+    pop_expired(found->second);
+    if (found->second.empty()) {
+        return {};
+    }
+    return *found->second.front();
+}
+
+std::optional<License> License_Manager::get_license(const std::string& id) {
+    std::lock_guard<std::mutex> lock{mtx_};
+    auto found = licenses_.find(id);
+    if (found == licenses_.end() || expired(found->second)) {
+        return {};
+    }
+    return found->second;
+}
+
+/// ---------------------------------------- License_Reminders ---------------------------------------
+#pragma region License_Reminders
+
+License_Reminders::License_Reminders(dpp::cluster* bot, std::string file) : bot_(bot), file_(std::move(file)) {}
+
+License_Reminders::~License_Reminders() {
+    if (timer_) {
+        bot_->stop_timer(timer_);
+    }
+}
+
+void License_Reminders::start(Fire_Fn on_fire) {
+    on_fire_ = std::move(on_fire);
+    load();
+    timer_ = bot_->start_timer([this](dpp::timer) { fire_due(); }, s_tick);
+}
+
+bool License_Reminders::add(const License& license, system_clock::time_point fire_at, system_clock::time_point ends_at,
+                            dpp::snowflake channel, dpp::snowflake user) {
+    std::lock_guard<std::mutex> lock{mtx_};
+    auto [it, inserted] = reminders_.try_emplace(license.id, Reminder{license, channel, fire_at, ends_at, {}});
+    if (inserted) {
+        deadlines_.emplace(fire_at, license.id);
+    }
+
+    if (!it->second.users.insert(user).second) {
+        return false;
+    }
+
+    save();
+    return true;
+}
+
+bool License_Reminders::has(const std::string& license_id, dpp::snowflake user) {
+    std::lock_guard<std::mutex> lock{mtx_};
+    auto found = reminders_.find(license_id);
+    return found != reminders_.end() && found->second.users.count(user) != 0;
+}
+
+void License_Reminders::fire_due() {
+    std::vector<Reminder> due;
+    {
+        std::lock_guard<std::mutex> lock{mtx_};
+        const auto now = system_clock::now();
+        while (!deadlines_.empty() && deadlines_.begin()->first <= now) {
+            auto found = reminders_.find(deadlines_.begin()->second);
+            if (found != reminders_.end()) {
+                // a reminder the bot was down for is only late, one for an auction that ended is dropped
+                if (found->second.ends_at > now) {
+                    due.push_back(std::move(found->second));
+                }
+                reminders_.erase(found);
             }
-        } else {
-            return {};
+            deadlines_.erase(deadlines_.begin());
+        }
+
+        if (!due.empty()) {
+            save();
+        }
+    }
+
+    for (const auto& reminder : due) {
+        logger->debug("Firing license reminder {} for {} users", reminder.license.id, reminder.users.size());
+        on_fire_(reminder);
+    }
+}
+
+void License_Reminders::load() {
+    std::ifstream f{file_};
+    if (!f.is_open()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock{mtx_};
+    try {
+        for (const auto& r : json::parse(f)) {
+            Reminder reminder{r.at("license").get<License>(), r.at("channel").get<uint64_t>(),
+                              system_clock::time_point{seconds{r.at("fire_at").get<int64_t>()}},
+                              system_clock::time_point{seconds{r.at("ends_at").get<int64_t>()}},
+                              {}};
+            for (uint64_t user : r.at("users").get<std::vector<uint64_t>>()) {
+                reminder.users.insert(user);
+            }
+
+            deadlines_.emplace(reminder.fire_at, reminder.license.id);
+            reminders_.emplace(reminder.license.id, std::move(reminder));
+        }
+        logger->info("Loaded {} pending license reminders", reminders_.size());
+    } catch (const json::exception& e) {
+        logger->warn("Parsing license reminders failed with: {}", e.what());
+    }
+}
+
+void License_Reminders::save() {
+    json j = json::array();
+    for (const auto& [id, r] : reminders_) {
+        std::vector<uint64_t> users(r.users.begin(), r.users.end());
+        j.push_back({{"license", r.license},
+                     {"channel", static_cast<uint64_t>(r.channel)},
+                     {"fire_at", duration_cast<seconds>(r.fire_at.time_since_epoch()).count()},
+                     {"ends_at", duration_cast<seconds>(r.ends_at.time_since_epoch()).count()},
+                     {"users", users}});
+    }
+
+    // write then rename, a crash never leaves half a file
+    const std::string tmp_path = file_ + ".tmp";
+    {
+        std::ofstream f{tmp_path, std::ios::trunc};
+        if (!f.is_open()) {
+            logger->error("Failed to open the license reminders file (on save)");
+            return;
         }
+        f << j;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, file_, ec);
+    if (ec) {
+        logger->error("Failed to save the license reminders: {}", ec.message());
     }
 }
 
+#pragma endregion License_Reminders
+
 }   // namespace railcord
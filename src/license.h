@@ -1,11 +1,18 @@
 #ifndef LICENSE_H
 #define LICENSE_H
 
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <deque>
+#include <functional>
+#include <map>
 #include <mutex>
 #include <optional>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 
 // clang-format off
 #include <dpp/json.h>
@@ -19,6 +26,7 @@ struct GameResource;
 using Good = GameResource;
 
 static constexpr int s_request_license_timeout = 90;   // seconds
+inline constexpr const char* s_license_reminders_file{"license_reminders.json"};
 
 struct License {
     std::string id;
@@ -29,7 +37,7 @@ struct License {
     int good_type;
 
     struct Embed_Data {
-        const std::vector<dpp::snowflake> users;
+        std::vector<dpp::snowflake> users;
         const Good* good;
         const License* license;
         const std::chrono::system_clock::time_point end_tp;
@@ -43,21 +51,91 @@ class License_Manager {
     License_Manager(License_Manager&&) = delete;
     License_Manager& operator=(const License_Manager&) = delete;
     License_Manager& operator=(License_Manager&&) = delete;
+    ~License_Manager();
+
+    // Keeps the licenses warm in the background, lookups only ever read what was already fetched
+    void start();
+    void stop();
+    void request_refresh();   // wakes the refresher, never blocks
+    bool ready() const { return ready_.load(); }   // a fetch succeeded at least once
 
     std::optional<License> get_next_license(int good_type);
-    void update_state();
+    std::optional<License> get_license(const std::string& id);   // empty once it expired
     std::chrono::system_clock::time_point get_start_tp(const License& license);
     std::chrono::system_clock::time_point get_end_tp(const License& license);
     std::chrono::system_clock::duration time_left_to_start(const License& license);
     bool expired(const License& license);
     bool is_currently_active(const License& license);
 
+    static constexpr size_t s_min_licenses = 4 * 12;   // 12hrs
+    static constexpr std::chrono::minutes s_refresh_interval{15};
+    static constexpr std::chrono::seconds s_retry_interval{60};
+
   private:
-    void fetch_new_licenses();
+    void refresher();
+    bool refresh();   // on the refresher thread only, false if the fetch failed
+    bool needs_fetch();
+    bool fetch_new_licenses();
+    void merge(std::deque<License>&& fetched, std::chrono::system_clock::time_point fetched_at);
+    void pop_expired(std::deque<License*>& queue);
 
-    std::deque<License> licenses_;
-    std::chrono::system_clock::time_point t_offset_;
+    // licenses by AuctionId, every one of them is in the start ordered queue of its good
+    std::unordered_map<std::string, License> licenses_;
+    std::unordered_map<int, std::deque<License*>> by_good_;
+    std::chrono::system_clock::time_point t_offset_;   // start and end are relative to the first fetch
     mutable std::mutex mtx_;
+
+    std::thread refresh_thread_;
+    std::atomic_bool running_{false};
+    std::atomic_bool ready_{false};
+    bool refresh_requested_{false};
+    std::mutex refresh_mtx_;
+    std::condition_variable cv_;
+};
+
+// Pending /license reminders in deadline order, written to disk on every change. One timer fires whatever is
+// due and reminders saved before a restart are scheduled again on start
+class License_Reminders {
+  public:
+    struct Reminder {
+        License license;
+        dpp::snowflake channel;
+        std::chrono::system_clock::time_point fire_at;
+        std::chrono::system_clock::time_point ends_at;
+        std::unordered_set<dpp::snowflake> users;
+    };
+    using Fire_Fn = std::function<void(const Reminder&)>;
+
+    License_Reminders(dpp::cluster* bot, std::string file = s_license_reminders_file);
+    License_Reminders(const License_Reminders&) = delete;
+    License_Reminders(License_Reminders&&) = delete;
+    License_Reminders& operator=(const License_Reminders&) = delete;
+    License_Reminders& operator=(License_Reminders&&) = delete;
+    ~License_Reminders();
+
+    // Loads the saved reminders and starts the scheduler, on_fire runs on a cluster timer thread
+    void start(Fire_Fn on_fire);
+
+    // False if the user already waits for this license
+    bool add(const License& license, std::chrono::system_clock::time_point fire_at,
+             std::chrono::system_clock::time_point ends_at, dpp::snowflake channel, dpp::snowflake user);
+    bool has(const std::string& license_id, dpp::snowflake user);
+
+    static constexpr uint64_t s_tick = 1;   // seconds
+
+  private:
+    void fire_due();
+    void load();
+    void save();   // with mtx_ held
+
+    dpp::cluster* bot_;
+    std::string file_;
+    Fire_Fn on_fire_;
+    dpp::timer timer_{};
+
+    std::mutex mtx_;
+    std::unordered_map<std::string, Reminder> reminders_;   // by license id
+    std::multimap<std::chrono::system_clock::time_point, std::string> deadlines_;
 };
 
 void from_json(const nlohmann::json& j, License& l);
@@ -8,6 +8,7 @@
 #include "gamedata.h"
 #include "logger.h"
 #include "lucy.h"
+#include "metrics.h"
 #include "lucyapi.h"
 #include "personality_watcher.h"
 #include "util.h"
@@ -18,10 +19,36 @@ dpp::snowflake test_server{};
 dpp::snowflake Lucy::s_bot_owner;
 std::unordered_map<int, std::string> api_endpoints;
 
+static void report_memory(const char* when) {
+    if (auto rss = util::resident_memory()) {
+        logger->info("Resident memory {}: {:.1f} MiB", when, static_cast<double>(*rss) / (1 << 20));
+    }
+}
+
 Lucy::Lucy() : Lucy(railcord::util::get_token(token_file)) {}
 
-Lucy::Lucy(const std::string& token)
-    : bot(token), alert_manager_(&bot), watcher_(&bot, &gamedata_, &alert_manager_), cmd_handler_(this) {}
+Lucy::Lucy(const std::string& token) : Lucy(token, Gateway_Config::load(settings_file)) {}
+
+Lucy::Lucy(const std::string& token, const Gateway_Config& gateway)
+    : bot(token, gateway.intents, 0, 0, 1, true, gateway.cache), worlds_(&bot, &registry_), cmd_handler_(this),
+      metrics_server_(&metrics) {
+    logger->info("Gateway: {}", gateway.describe());
+
+    metrics.gauge_fn(
+        "lucy_rest_requests", "Discord REST requests queued or in flight", {{"queue", "rest"}},
+        [this]() { return static_cast<double>(bot.rest->get_active_request_count()); }, this);
+    metrics.gauge_fn(
+        "lucy_rest_requests", "Discord REST requests queued or in flight", {{"queue", "raw"}},
+        [this]() { return static_cast<double>(bot.raw_rest->get_active_request_count()); }, this);
+    metrics.gauge_fn(
+        "lucy_resident_bytes", "Resident memory of the process", {},
+        []() { return static_cast<double>(util::resident_memory().value_or(0)); }, this);
+}
+
+Lucy::~Lucy() {
+    metrics_server_.stop();
+    metrics.remove(this);
+}
 
 void Lucy::init(int argc, const char* argv[]) {
 #ifdef USE_SPDLOG
@@ -29,23 +56,41 @@ void Lucy::init(int argc, const char* argv[]) {
 #else
     bot.on_log(dpp::utility::cout_logger());
 #endif
+    util::Phase_Timer startup{"Lucy init"};
     load_settings();
+    startup.lap("settings");
 
     const auto action = cmd::parse_cmdline(argc, argv);
     if (action != cmd::BotAction::INIT) {
         cmd::do_cmdline_action(action, this);
     } else {
-        gamedata_.init();
+        gamedata_ = registry_.get(worlds_.main().game_mode());
+        startup.lap("gamedata");
 
         cmd_handler_.load_all_commands();
+        startup.lap("commands");
+
         cmd_handler_.on_slash_cmd();
         cmd_handler_.on_form_submit();
         cmd_handler_.on_button_click();
         cmd_handler_.on_select_click();
+
+        if (metrics_port_) {
+            metrics_server_.start(metrics_port_);
+        }
     }
 
+    bot.on_ready([](const dpp::ready_t&) {
+        if (dpp::run_once<struct report_ready_memory>()) {
+            report_memory("at gateway ready");
+        }
+    });
+
     running_.store(true);
     bot.start();
+    startup.lap("cluster start");
+    startup.finish();
+    report_memory("after startup");
 
     {
         std::mutex thread_mutex;
@@ -58,9 +103,20 @@ void Lucy::init(int argc, const char* argv[]) {
     }
 }
 
+bool Lucy::reload_permissions() {
+    INIReader settings{settings_file};
+    if (int err = settings.ParseError()) {
+        logger->error("Could not reload permissions, settings parse error {}", err);
+        return false;
+    }
+
+    permissions_.set_policy(Permission_Policy::load(settings, s_bot_owner));
+    return true;
+}
+
 void Lucy::load_settings() {
     logger->debug("Loading lucy settings...");
-    INIReader* settings = new INIReader("lucy.ini");
+    INIReader* settings = new INIReader(settings_file);
 
     if (int err = settings->ParseError()) {
         if (err == -1) {
@@ -76,38 +132,26 @@ void Lucy::load_settings() {
     int port = settings->GetInteger("Lucy", "api_port", 6969);
     bool https = settings->GetInteger64("Lucy", "https", 0);
 
-    std::string url = util::fmt_http_request(server, port, settings->Get("Lucy", "sync_time_endpoint", ""), https);
-    api_endpoints.insert(std::make_pair(api::sync_time_id, url));
-
-    url = util::fmt_http_request(server, port, settings->Get("Lucy", "personality_endpoint", ""), https);
-    api_endpoints.insert(std::make_pair(api::personality_id, url));
-
-    url = util::fmt_http_request(server, port, settings->Get("Lucy", "license_endpoint", ""), https);
+    std::string url = util::fmt_http_request(server, port, settings->Get("Lucy", "license_endpoint", ""), https);
     api_endpoints.insert(std::make_pair(api::license_id, url));
 
     api_endpoints.insert(std::make_pair(api::worker_art_id, settings->Get("Lucy", "worker_art_endpoint", "")));
 
-    alert_manager_.set_alert_channel(settings->GetUnsigned64("Lucy", "channel", 0));
-    alert_manager_.set_alert_role(settings->GetUnsigned64("Lucy", "alert_role", 0));
-
-    bot_admin_role_ = settings->GetUnsigned64("Lucy", "bot_admin_role", 0);
-
-    if (bot_admin_role_.empty()) {
-        logger->warn("Bot admin role default initialized to 0");
-    }
+    worlds_.configure(*settings);   // the endpoints, channel, alert_role, board, game_mode and use_local_time
 
-    watcher_.set_using_local_time(settings->GetInteger("Lucy", "use_local_time", 1));
+    const uint64_t budget_mb = GameData_Registry::s_default_budget >> 20;
+    registry_.set_budget(settings->GetUnsigned64("Lucy", "gamedata_budget_mb", budget_mb) << 20);
+    cmd_handler_.set_rate_limits(settings->Get("Lucy", "rate_limits", ""));   // e.g. license:2/3,watch:1/10
+    metrics_port_ = static_cast<uint16_t>(settings->GetUnsigned("Lucy", "metrics_port", 0));   // 0 is off
 
     test_server = settings->GetUnsigned64("Lucy", "test_server", 0);
 
-    whitelist_.push_back(settings->GetUnsigned64("Lucy", "user1", 0));
-    whitelist_.push_back(settings->GetUnsigned64("Lucy", "user2", 0));
-    whitelist_.push_back(s_bot_owner);
+    permissions_.set_policy(Permission_Policy::load(*settings, s_bot_owner));
     custom_emojis_.emplace_back("rnback", settings->GetUnsigned64("Lucy", "rnback", 0));
 
     delete settings;
 
-    if (alert_manager_.load_state()) {
+    if (worlds_.load_state()) {
         logger->info("Alert manager state loaded");
     } else {
         throw std::runtime_error{"Failed to load the alert manager state"};
@@ -117,7 +161,7 @@ void Lucy::load_settings() {
 void Lucy::shutdown() {
     static std::once_flag s_flag;
     std::call_once(s_flag, [this]() {
-        alert_manager_.save_state();
+        worlds_.save_state();
         (void) std::async(std::launch::async, [this]() {
             running_.store(false);
             std::this_thread::sleep_for(std::chrono::seconds{5});
@@ -10,12 +10,18 @@
 #include "alert_manager.h"
 #include "cmd/command_handler.h"
 #include "gamedata.h"
+#include "gamedata_registry.h"
+#include "gateway.h"
+#include "metrics_server.h"
+#include "permissions.h"
 #include "personality_watcher.h"
+#include "world.h"
 
 namespace railcord {
 
 extern dpp::snowflake test_server;
 inline constexpr const char* token_file = "resources/token.txt";
+inline constexpr const char* settings_file = "lucy.ini";
 
 class Lucy {
   public:
@@ -25,33 +31,38 @@ class Lucy {
     Lucy(Lucy&&) = delete;
     Lucy& operator=(const Lucy&) = delete;
     Lucy& operator=(Lucy&&) = delete;
+    ~Lucy();
 
     void init(int argc, const char* argv[]);
     void load_settings();
+    bool reload_permissions();   // from lucy.ini, while running
 
     bool is_running() { return running_.load(); }
     void shutdown();
 
-    GameData* gamedata() { return &gamedata_; }
-    Alert_Manager* alert_manager() { return &alert_manager_; }
-    personality_watcher* watcher() { return &watcher_; }
+    GameData* gamedata() { return gamedata_.get(); }   // the default game mode
+    GameData_Registry* gamedata_registry() { return &registry_; }
+    World_Set* worlds() { return &worlds_; }
+    Alert_Manager* alert_manager() { return worlds_.main().alert_manager(); }   // of the main world
     cmd::Command_handler* cmd_handler() { return &cmd_handler_; }
-    const std::vector<dpp::snowflake>& user_whitelist() { return whitelist_; }
+    Permissions* permissions() { return &permissions_; }
     const std::vector<dpp::emoji>& custom_emojis() { return custom_emojis_; }
-    dpp::snowflake bot_admin_role() const { return bot_admin_role_; }
     static dpp::snowflake s_bot_owner;
 
     dpp::cluster bot;
 
   private:
+    Lucy(const std::string& token, const Gateway_Config& gateway);
+
     std::atomic_bool running_;
-    GameData gamedata_;
-    Alert_Manager alert_manager_;
-    personality_watcher watcher_;
+    GameData_Registry registry_;
+    std::shared_ptr<GameData> gamedata_;
+    World_Set worlds_;
     cmd::Command_handler cmd_handler_;
-    dpp::snowflake bot_admin_role_;
-    std::vector<dpp::snowflake> whitelist_;
+    Permissions permissions_;
     std::vector<dpp::emoji> custom_emojis_;
+    uint16_t metrics_port_{0};
+    Metrics_Server metrics_server_;   // last, it reads the gauges of the members above
 };
 
 }   // namespace railcord
@@ -7,9 +7,8 @@
 namespace railcord {
     extern std::unordered_map<int, std::string> api_endpoints;
 
+    // The personality and sync time endpoints are per world, see World_Config
     enum api {
-        sync_time_id = 0,
-        personality_id = 1,
         worker_art_id = 2,
         license_id = 3
     };
@@ -62,4 +62,26 @@ void MessageTracker::delete_all_messages(bool wait_deletion) {
     msgs_.clear();
 }
 
+dpp::task<void> MessageTracker::co_delete_all_messages() {
+    std::vector<SentMessage> msgs;
+    {
+        std::lock_guard<std::mutex> lock{mtx_};
+        msgs.swap(msgs_);
+    }
+
+    for (const auto& msg : msgs) {
+        logger->info("Deleting message(all) id={}", static_cast<uint64_t>(msg.id));
+        auto cc = co_await bot_->co_message_delete(msg.id, msg.channel_id);
+        if (cc.is_error()) {
+            logger->warn("Deleting message(all) id={} failed with: {}", static_cast<uint64_t>(msg.id),
+                         cc.get_error().message);
+        }
+    }
+}
+
+size_t MessageTracker::size() {
+    std::lock_guard<std::mutex> lock{mtx_};
+    return msgs_.size();
+}
+
 }   // namespace railcord
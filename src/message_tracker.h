@@ -25,6 +25,8 @@ class MessageTracker {
     void remove_message(const dpp::snowflake id);
     void delete_message(const dpp::snowflake id, const std::string& info = "");
     void delete_all_messages(bool wait_deletion = false);
+    dpp::task<void> co_delete_all_messages();   // waits for each deletion without blocking a thread
+    size_t size();
 
     const static uint64_t s_delete_message_delay = 180;
 
@@ -0,0 +1,228 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include "metrics.h"
+
+namespace railcord {
+
+Metrics metrics;
+
+static std::string format_labels(Metrics::Labels labels) {
+    std::string s;
+    for (const auto& [key, value] : labels) {
+        if (!s.empty()) {
+            s.push_back(',');
+        }
+        s.append(key).append("=\"");
+        for (char c : value) {
+            if (c == '\\' || c == '"') {
+                s.push_back('\\');
+                s.push_back(c);
+            } else if (c == '\n') {
+                s.append("\\n");
+            } else {
+                s.push_back(c);
+            }
+        }
+        s.push_back('"');
+    }
+    return s;
+}
+
+static std::string fmt_us(uint64_t us) {
+    if (us < 1000) {
+        return fmt::format("{}us", us);
+    }
+    if (us < 1000000) {
+        return fmt::format("{:.1f}ms", static_cast<double>(us) / 1e3);
+    }
+    return fmt::format("{:.2f}s", static_cast<double>(us) / 1e6);
+}
+
+/// ---------------------------------------- Histogram ---------------------------------------
+#pragma region Histogram
+
+uint64_t Histogram::count() const {
+    uint64_t total = 0;
+    for (const auto& c : counts_) {
+        total += c.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t Histogram::quantile_us(double q) const {
+    const uint64_t total = count();
+    if (!total) {
+        return 0;
+    }
+
+    const auto rank = static_cast<uint64_t>(q * static_cast<double>(total - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < s_buckets; ++i) {
+        seen += counts_[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            return std::min(upper_bound(i), max_us());
+        }
+    }
+    return max_us();
+}
+
+uint64_t Histogram::count_le_us(uint64_t bound) const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < s_buckets && upper_bound(i) <= bound; ++i) {
+        total += counts_[i].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+std::string Histogram::summary() const {
+    return fmt::format("n:{} p50:{} p90:{} p99:{} max:{}", count(), fmt_us(quantile_us(0.5)),
+                       fmt_us(quantile_us(0.9)), fmt_us(quantile_us(0.99)), fmt_us(max_us()));
+}
+
+#pragma endregion Histogram
+
+/// ---------------------------------------- Metrics ---------------------------------------
+#pragma region Metrics
+
+Metrics::Series& Metrics::series(std::string_view name, std::string_view help, Kind kind, Labels labels) {
+    std::string l = format_labels(labels);
+
+    auto family = std::find_if(families_.begin(), families_.end(), [name](const Family& f) { return f.name == name; });
+    if (family == families_.end()) {
+        family = families_.insert(families_.end(), Family{std::string{name}, std::string{help}, kind, {}});
+    } else if (family->kind != kind) {
+        throw std::logic_error{fmt::format("Metric {} registered with two types", name)};
+    }
+
+    auto found = std::find_if(family->series.begin(), family->series.end(),
+                              [&l](const Series& s) { return s.labels == l; });
+    if (found != family->series.end()) {
+        return *found;
+    }
+
+    Series& s = family->series.emplace_back();
+    s.labels = std::move(l);
+    switch (kind) {
+        case Kind::counter:
+            s.counter = std::make_unique<Counter>();
+            break;
+        case Kind::gauge:
+            s.gauge = std::make_unique<Gauge>();
+            break;
+        case Kind::histogram:
+            s.histogram = std::make_unique<Histogram>();
+            break;
+    }
+    return s;
+}
+
+Counter& Metrics::counter(std::string_view name, std::string_view help, Labels labels) {
+    std::lock_guard<std::mutex> lock{mtx_};
+    return *series(name, help, Kind::counter, labels).counter;
+}
+
+Gauge& Metrics::gauge(std::string_view name, std::string_view help, Labels labels) {
+    std::lock_guard<std::mutex> lock{mtx_};
+    return *series(name, help, Kind::gauge, labels).gauge;
+}
+
+Histogram& Metrics::histogram(std::string_view name, std::string_view help, Labels labels) {
+    std::lock_guard<std::mutex> lock{mtx_};
+    return *series(name, help, Kind::histogram, labels).histogram;
+}
+
+void Metrics::gauge_fn(std::string_view name, std::string_view help, Labels labels, std::function<double()> fn,
+                       const void* owner) {
+    std::lock_guard<std::mutex> lock{mtx_};
+    Series& s = series(name, help, Kind::gauge, labels);
+    s.fn = std::move(fn);
+    s.owner = owner;
+}
+
+void Metrics::remove(const void* owner) {
+    std::lock_guard<std::mutex> lock{mtx_};
+    for (auto& family : families_) {
+        std::erase_if(family.series, [owner](const Series& s) { return s.owner == owner; });
+    }
+}
+
+std::string Metrics::prometheus() const {
+    // seconds bounds at 2^n - 1 microseconds, 255us to ~67s
+    static constexpr unsigned s_first_bound = 8;
+    static constexpr unsigned s_last_bound = 26;
+
+    std::lock_guard<std::mutex> lock{mtx_};
+    std::string out;
+    for (const auto& f : families_) {
+        if (f.series.empty()) {
+            continue;
+        }
+
+        static constexpr const char* s_types[] = {"counter", "gauge", "histogram"};
+        out.append(fmt::format("# HELP {} {}\n# TYPE {} {}\n", f.name, f.help, f.name,
+                               s_types[static_cast<size_t>(f.kind)]));
+
+        for (const auto& s : f.series) {
+            const std::string braced = s.labels.empty() ? "" : "{" + s.labels + "}";
+            const std::string sep = s.labels.empty() ? "" : ",";
+            switch (f.kind) {
+                case Kind::counter:
+                    out.append(fmt::format("{}{} {}\n", f.name, braced, s.counter->value()));
+                    break;
+                case Kind::gauge:
+                    if (s.fn) {
+                        out.append(fmt::format("{}{} {}\n", f.name, braced, s.fn()));
+                    } else {
+                        out.append(fmt::format("{}{} {}\n", f.name, braced, s.gauge->value()));
+                    }
+                    break;
+                case Kind::histogram: {
+                    const Histogram& h = *s.histogram;
+                    for (unsigned n = s_first_bound; n <= s_last_bound; ++n) {
+                        const uint64_t bound = (uint64_t{1} << n) - 1;
+                        out.append(fmt::format("{}_bucket{{{}{}le=\"{}\"}} {}\n", f.name, s.labels, sep,
+                                               static_cast<double>(bound) / 1e6, h.count_le_us(bound)));
+                    }
+                    const uint64_t count = h.count();
+                    out.append(fmt::format("{}_bucket{{{}{}le=\"+Inf\"}} {}\n", f.name, s.labels, sep, count));
+                    out.append(fmt::format("{}_sum{} {}\n", f.name, braced, static_cast<double>(h.sum_us()) / 1e6));
+                    out.append(fmt::format("{}_count{} {}\n", f.name, braced, count));
+                    break;
+                }
+            }
+        }
+    }
+    return out;
+}
+
+std::string Metrics::summary() const {
+    std::lock_guard<std::mutex> lock{mtx_};
+    std::string out;
+    for (const auto& f : families_) {
+        for (const auto& s : f.series) {
+            const std::string braced = s.labels.empty() ? "" : "{" + s.labels + "}";
+            switch (f.kind) {
+                case Kind::counter:
+                    out.append(fmt::format("{}{} {}\n", f.name, braced, s.counter->value()));
+                    break;
+                case Kind::gauge:
+                    out.append(fmt::format("{}{} {}\n", f.name, braced,
+                                           s.fn ? s.fn() : static_cast<double>(s.gauge->value())));
+                    break;
+                case Kind::histogram:
+                    if (s.histogram->count()) {
+                        out.append(fmt::format("{}{} {}\n", f.name, braced, s.histogram->summary()));
+                    }
+                    break;
+            }
+        }
+    }
+    return out;
+}
+
+#pragma endregion Metrics
+
+}   // namespace railcord
@@ -0,0 +1,151 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace railcord {
+
+class Counter {
+  public:
+    void inc(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+  private:
+    std::atomic<uint64_t> value_{0};
+};
+
+class Gauge {
+  public:
+    void set(int64_t v) { value_.store(v, std::memory_order_relaxed); }
+    void add(int64_t n) { value_.fetch_add(n, std::memory_order_relaxed); }
+    int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+  private:
+    std::atomic<int64_t> value_{0};
+};
+
+// Durations in microseconds, HDR style: 4 linear sub buckets per power of two so any quantile is within 25%,
+// recording is a couple of relaxed atomic adds
+class Histogram {
+  public:
+    void record(std::chrono::steady_clock::duration d) {
+        const auto us = std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+        record_us(us > 0 ? static_cast<uint64_t>(us) : 0);
+    }
+    void record_us(uint64_t us) {
+        counts_[index(us)].fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(us, std::memory_order_relaxed);
+        uint64_t max = max_.load(std::memory_order_relaxed);
+        while (us > max && !max_.compare_exchange_weak(max, us, std::memory_order_relaxed)) {
+        }
+    }
+
+    uint64_t count() const;
+    uint64_t sum_us() const { return sum_.load(std::memory_order_relaxed); }
+    uint64_t max_us() const { return max_.load(std::memory_order_relaxed); }
+    uint64_t quantile_us(double q) const;   // upper bound of the bucket holding it
+    uint64_t count_le_us(uint64_t bound) const;   // bound is 2^n - 1
+    std::string summary() const;   // "n:12 p50:1.2ms p90:3.4ms p99:8ms max:9.1ms"
+
+    static constexpr unsigned s_sub_bits = 2;
+    static constexpr unsigned s_max_exp = 39;   // ~6 days, longer durations land in the last bucket
+    static constexpr size_t s_buckets = ((s_max_exp - 1) << s_sub_bits) + (1 << s_sub_bits);
+
+    static constexpr size_t index(uint64_t v) {
+        constexpr uint64_t sub = 1 << s_sub_bits;
+        if (v < sub) {
+            return static_cast<size_t>(v);
+        }
+        const unsigned e = std::min<unsigned>(std::bit_width(v) - 1, s_max_exp);
+        if (e == s_max_exp) {
+            return s_buckets - 1;
+        }
+        return ((e - s_sub_bits + 1) << s_sub_bits) + ((v >> (e - s_sub_bits)) & (sub - 1));
+    }
+    static constexpr uint64_t upper_bound(size_t i) {   // inclusive
+        constexpr uint64_t sub = 1 << s_sub_bits;
+        if (i < sub) {
+            return i;
+        }
+        const unsigned e = static_cast<unsigned>(i >> s_sub_bits) + s_sub_bits - 1;
+        return ((sub + (i & (sub - 1)) + 1) << (e - s_sub_bits)) - 1;
+    }
+
+  private:
+    std::array<std::atomic<uint64_t>, s_buckets> counts_{};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+// Records the time until it goes out of scope, which may span co_awaits
+class Scoped_Timer {
+  public:
+    explicit Scoped_Timer(Histogram& h) : h_(h), start_(std::chrono::steady_clock::now()) {}
+    Scoped_Timer(const Scoped_Timer&) = delete;
+    Scoped_Timer& operator=(const Scoped_Timer&) = delete;
+    ~Scoped_Timer() { h_.record(std::chrono::steady_clock::now() - start_); }
+
+  private:
+    Histogram& h_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// The metrics of the process, by name and labels. Lookups lock and are meant to be done once, the returned
+// references stay valid for the life of the registry and are updated without locking
+class Metrics {
+  public:
+    using Labels = std::initializer_list<std::pair<std::string_view, std::string_view>>;
+
+    Counter& counter(std::string_view name, std::string_view help, Labels labels = {});
+    Gauge& gauge(std::string_view name, std::string_view help, Labels labels = {});
+    Histogram& histogram(std::string_view name, std::string_view help, Labels labels = {});   // in seconds
+
+    // Gauges read when exported, fn may lock. They are dropped by remove(owner), before owner goes
+    void gauge_fn(std::string_view name, std::string_view help, Labels labels, std::function<double()> fn,
+                  const void* owner);
+    void remove(const void* owner);
+
+    std::string prometheus() const;   // text exposition format 0.0.4
+    std::string summary() const;      // one line per series, for /stats
+
+  private:
+    enum class Kind : uint8_t { counter, gauge, histogram };
+    struct Series {
+        std::string labels;   // name="value",..
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Gauge> gauge;
+        std::unique_ptr<Histogram> histogram;
+        std::function<double()> fn;
+        const void* owner{nullptr};
+    };
+    struct Family {
+        std::string name;
+        std::string help;
+        Kind kind;
+        std::vector<Series> series;
+    };
+
+    Series& series(std::string_view name, std::string_view help, Kind kind, Labels labels);
+
+    mutable std::mutex mtx_;
+    std::vector<Family> families_;   // in registration order
+};
+
+extern Metrics metrics;
+
+}   // namespace railcord
+
+#endif   // !METRICS_H
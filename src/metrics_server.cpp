@@ -0,0 +1,140 @@
+#ifdef WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include <string>
+#include <string_view>
+
+#include <fmt/format.h>
+
+#include "logger.h"
+#include "metrics.h"
+#include "metrics_server.h"
+
+namespace railcord {
+
+#ifdef WIN32
+using socket_t = SOCKET;
+static void close_socket(socket_t s) { closesocket(s); }
+static int poll_one(socket_t s, int timeout_ms) {
+    WSAPOLLFD pfd{s, POLLIN, 0};
+    return WSAPoll(&pfd, 1, timeout_ms);
+}
+static constexpr socket_t s_invalid_socket = INVALID_SOCKET;
+#else
+using socket_t = int;
+static void close_socket(socket_t s) { close(s); }
+static int poll_one(socket_t s, int timeout_ms) {
+    pollfd pfd{s, POLLIN, 0};
+    return poll(&pfd, 1, timeout_ms);
+}
+static constexpr socket_t s_invalid_socket = -1;
+#endif
+
+bool Metrics_Server::start(uint16_t port) {
+    if (running_.load()) {
+        return true;
+    }
+
+#ifdef WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        logger->error("Metrics server: WSAStartup failed");
+        return false;
+    }
+#endif
+
+    socket_t listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener == s_invalid_socket) {
+        logger->error("Metrics server: could not create a socket");
+        return false;
+    }
+
+    int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof reuse);
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);   // local only, put a proxy in front to scrape from elsewhere
+    if (bind(listener, reinterpret_cast<const sockaddr*>(&addr), sizeof addr) != 0 || listen(listener, 8) != 0) {
+        logger->error("Metrics server: could not listen on 127.0.0.1:{}", port);
+        close_socket(listener);
+        return false;
+    }
+
+    running_.store(true);
+    thread_ = std::thread{&Metrics_Server::serve, this, static_cast<intptr_t>(listener)};
+    logger->info("Serving metrics on http://127.0.0.1:{}/metrics", port);
+    return true;
+}
+
+void Metrics_Server::stop() {
+    running_.store(false);
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void Metrics_Server::serve(intptr_t listener) {
+    const auto sock = static_cast<socket_t>(listener);
+    while (running_.load()) {
+        if (poll_one(sock, s_poll_ms) <= 0) {
+            continue;
+        }
+
+        socket_t client = accept(sock, nullptr, nullptr);
+        if (client == s_invalid_socket) {
+            continue;
+        }
+        respond(static_cast<intptr_t>(client));
+        close_socket(client);
+    }
+    close_socket(sock);
+}
+
+void Metrics_Server::respond(intptr_t client) const {
+    const auto sock = static_cast<socket_t>(client);
+
+    // only the request line matters, the scrapers send small requests
+    std::string request;
+    char buf[1024];
+    while (request.find("\r\n") == std::string::npos && request.size() < 4 * sizeof buf) {
+        if (poll_one(sock, s_recv_timeout_ms) <= 0) {
+            return;
+        }
+        auto n = recv(sock, buf, sizeof buf, 0);
+        if (n <= 0) {
+            return;
+        }
+        request.append(buf, static_cast<size_t>(n));
+    }
+
+    std::string_view line{request};
+    line = line.substr(0, line.find("\r\n"));
+    const bool found = line.starts_with("GET /metrics ") || line.starts_with("GET /metrics?");
+
+    const std::string body = found ? metrics_->prometheus() : "Not found\n";
+    const std::string response =
+        fmt::format("HTTP/1.1 {}\r\nContent-Type: {}\r\nContent-Length: {}\r\nConnection: close\r\n\r\n{}",
+                    found ? "200 OK" : "404 Not Found",
+                    found ? "text/plain; version=0.0.4; charset=utf-8" : "text/plain", body.size(), body);
+
+    size_t sent = 0;
+    while (sent < response.size()) {
+        auto n = send(sock, response.data() + sent, static_cast<int>(response.size() - sent), 0);
+        if (n <= 0) {
+            return;
+        }
+        sent += static_cast<size_t>(n);
+    }
+}
+
+}   // namespace railcord
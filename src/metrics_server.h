@@ -0,0 +1,37 @@
+#ifndef METRICS_SERVER_H
+#define METRICS_SERVER_H
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+namespace railcord {
+
+class Metrics;
+
+// Serves GET /metrics in the Prometheus text format on 127.0.0.1 only, one connection at a time
+class Metrics_Server {
+  public:
+    Metrics_Server(const Metrics* metrics) : metrics_(metrics) {}
+    Metrics_Server(const Metrics_Server&) = delete;
+    Metrics_Server& operator=(const Metrics_Server&) = delete;
+    ~Metrics_Server() { stop(); }
+
+    bool start(uint16_t port);   // false when the port could not be bound
+    void stop();
+
+    static constexpr int s_poll_ms = 500;   // how long stop() may wait for the thread
+    static constexpr int s_recv_timeout_ms = 2000;
+
+  private:
+    void serve(intptr_t listener);
+    void respond(intptr_t client) const;
+
+    const Metrics* metrics_;
+    std::atomic_bool running_{false};
+    std::thread thread_;
+};
+
+}   // namespace railcord
+
+#endif   // !METRICS_SERVER_H
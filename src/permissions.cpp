@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <charconv>
+
+#include <INIReader.h>
+
+#include "logger.h"
+#include "permissions.h"
+#include "util.h"
+
+namespace railcord {
+using namespace std::chrono;
+
+static void add_ids(std::unordered_set<dpp::snowflake>& ids, std::string_view list) {
+    util::for_each_entry(list, [&ids](std::string_view entry) {
+        uint64_t id{};
+        if (std::from_chars(entry.data(), entry.data() + entry.size(), id).ec != std::errc{} || !id) {
+            logger->warn("Ignoring permission id \"{}\"", entry);
+            return;
+        }
+        ids.insert(id);
+    });
+}
+
+Permission_Policy Permission_Policy::load(const INIReader& settings, dpp::snowflake owner) {
+    Permission_Policy policy;
+    if (owner) {
+        policy.admins.insert(owner);
+    }
+
+    add_ids(policy.admins, settings.Get("Lucy", "user1", ""));
+    add_ids(policy.admins, settings.Get("Lucy", "user2", ""));
+    add_ids(policy.admins, settings.Get("Lucy", "whitelist", ""));
+    add_ids(policy.admin_roles, settings.Get("Lucy", "bot_admin_role", ""));
+    add_ids(policy.admin_roles, settings.Get("Lucy", "admin_roles", ""));
+
+    if (policy.admin_roles.empty()) {
+        logger->warn("No bot admin role set, only whitelisted users can use admin commands");
+    }
+
+    // name:level, everyone or admin. The configured entries are applied over the defaults
+    const std::string access = settings.Get("Lucy", "command_access", "");
+    const auto add_access = [&policy](std::string_view entry) {
+        auto colon = entry.find(':');
+        std::string_view level = colon == std::string_view::npos ? "" : entry.substr(colon + 1);
+        if (level != "everyone" && level != "admin") {
+            logger->warn("Ignoring command access \"{}\", expected name:everyone or name:admin", entry);
+            return;
+        }
+        policy.commands[std::string{entry.substr(0, colon)}] = level == "everyone" ? Access::everyone : Access::admin;
+    };
+    util::for_each_entry(s_default_command_access, add_access);
+    util::for_each_entry(access, add_access);
+
+    logger->info("Permissions: {} admins, {} admin roles, {} command rules", policy.admins.size(),
+                 policy.admin_roles.size(), policy.commands.size());
+    return policy;
+}
+
+void Permissions::set_policy(Permission_Policy policy) {
+    std::lock_guard<std::mutex> lock{mtx_};
+    policy_ = std::move(policy);
+    lru_.clear();
+    decisions_.clear();
+}
+
+bool Permissions::can_use(const dpp::slashcommand_t& event) {
+    std::lock_guard<std::mutex> lock{mtx_};
+    auto rule = policy_.commands.find(event.command.get_command_name());
+    Access access = rule != policy_.commands.end() ? rule->second : policy_.default_access;
+    return access == Access::everyone || is_admin(event);
+}
+
+bool Permissions::is_admin(const dpp::slashcommand_t& event) {
+    const Member_Key key{event.command.guild_id, event.command.usr.id};
+    const auto now = steady_clock::now();
+
+    auto found = decisions_.find(key);
+    if (found != decisions_.end()) {
+        if (now - found->second->at < s_cache_ttl) {
+            lru_.splice(lru_.begin(), lru_, found->second);
+            return found->second->admin;
+        }
+        lru_.erase(found->second);
+        decisions_.erase(found);
+    }
+
+    bool admin = policy_.admins.count(event.command.usr.id) > 0;
+    if (!admin) {
+        for (const auto& role : event.command.member.get_roles()) {
+            if (policy_.admin_roles.count(role)) {
+                admin = true;
+                break;
+            }
+        }
+    }
+
+    lru_.push_front(Decision{key, admin, now});
+    decisions_.emplace(key, lru_.begin());
+    if (lru_.size() > s_cache_size) {
+        decisions_.erase(lru_.back().key);
+        lru_.pop_back();
+    }
+    return admin;
+}
+
+}   // namespace railcord
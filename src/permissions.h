@@ -0,0 +1,73 @@
+#ifndef PERMISSIONS_H
+#define PERMISSIONS_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <dpp/dpp.h>
+
+class INIReader;
+
+namespace railcord {
+
+enum class Access : uint8_t { everyone, admin };
+
+inline constexpr const char* s_default_command_access = "license:everyone,subscribe:everyone";
+
+struct Permission_Policy {
+    std::unordered_set<dpp::snowflake> admins;        // by user id
+    std::unordered_set<dpp::snowflake> admin_roles;
+    std::unordered_map<std::string, Access> commands;   // by name, default_access if missing
+    Access default_access{Access::admin};
+
+    // From the [Lucy] section, user1, user2, whitelist, bot_admin_role, admin_roles and command_access
+    static Permission_Policy load(const INIReader& settings, dpp::snowflake owner);
+};
+
+// Who can use which slash command. The policy is swapped whole on reload and the admin check of recent
+// (guild, user) pairs is kept in a small LRU so the member roles are not scanned on every command
+class Permissions {
+  public:
+    Permissions() = default;
+    Permissions(const Permissions&) = delete;
+    Permissions& operator=(const Permissions&) = delete;
+
+    void set_policy(Permission_Policy policy);   // drops the cached decisions
+    bool can_use(const dpp::slashcommand_t& event);
+
+    static constexpr size_t s_cache_size = 256;
+    static constexpr std::chrono::seconds s_cache_ttl{60};   // roles can change without a reload
+
+  private:
+    struct Member_Key {
+        uint64_t guild;
+        uint64_t user;
+        bool operator==(const Member_Key& o) const { return guild == o.guild && user == o.user; }
+    };
+    struct Member_Key_Hash {
+        size_t operator()(const Member_Key& k) const { return std::hash<uint64_t>{}(k.guild * 31 ^ k.user); }
+    };
+    struct Decision {
+        Member_Key key;
+        bool admin;
+        std::chrono::steady_clock::time_point at;
+    };
+
+    bool is_admin(const dpp::slashcommand_t& event);   // with mtx_ held
+
+    std::mutex mtx_;
+    Permission_Policy policy_;
+    std::list<Decision> lru_;   // most recent first
+    std::unordered_map<Member_Key, std::list<Decision>::iterator, Member_Key_Hash> decisions_;
+};
+
+}   // namespace railcord
+
+#endif   // !PERMISSIONS_H
@@ -2,7 +2,6 @@
 #include <sstream>
 
 #include "gamedata.h"
-#include "lucyapi.h"
 #include "personality.h"
 #include "util.h"
 
@@ -19,13 +18,32 @@ std::string personality::information::str() const {
 
 std::string personality::str() const {
     std::stringstream ss;
-    ss << "Name: " << name << ", desc: " << description << "\nInfo:[ " << info.str() << " ]";
+    ss << "Name: " << name() << ", desc: " << description() << "\nInfo:[ " << info.str() << " ]";
     return ss.str();
 }
 
-personality::personality(personality::information i, std::string name, std::string description,
-                         const std::string* icon1, const std::string* icon2)
-    : info(i), name(std::move(name)), description(std::move(description)), main_icon(icon1), sec_icon(icon2) {}
+personality::personality(personality::information i, const Game_Dataset* dataset, uint32_t name, uint32_t description,
+                         icon_ref main_icon, icon_ref sec_icon)
+    : info(i),
+      dataset(dataset),
+      name_ref(name),
+      description_ref(description),
+      main_icon_ref(main_icon),
+      sec_icon_ref(sec_icon) {}
+
+std::string_view personality::name() const { return dataset ? dataset->str(name_ref) : std::string_view{}; }
+
+std::string_view personality::description() const {
+    return dataset ? dataset->str(description_ref) : std::string_view{};
+}
+
+std::string_view personality::main_icon() const {
+    return dataset ? dataset->icon(main_icon_ref) : std::string_view{};
+}
+
+std::string_view personality::sec_icon() const {
+    return dataset ? dataset->icon(sec_icon_ref) : std::string_view{};
+}
 
 std::string auction::str() const {
     std::stringstream ss{};
@@ -33,11 +51,11 @@ std::string auction::str() const {
     return ss.str();
 }
 
-std::string personality::get_art_url() const {
-    std::string tmp{api_endpoints.at(api::worker_art_id)};
-    tmp.reserve(8);
-    tmp.append(std::to_string(info.art_id)).append(".png");
-    return tmp;
+std::string_view personality::art_url() const { return dataset ? dataset->art_url(*this) : std::string_view{}; }
+
+const dpp::embed& personality::embed_template() const {
+    static const dpp::embed s_empty;
+    return dataset ? dataset->embed_template(*this) : s_empty;
 }
 
 void from_json(const nlohmann::json& j, auction& au) {
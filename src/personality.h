@@ -3,7 +3,9 @@
 
 #include <chrono>
 #include <cstdint>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 
 // clang-format off
@@ -14,7 +16,7 @@
 
 namespace railcord {
 
-class GameData;
+class Game_Dataset;
 struct personality {
     struct type {
         enum : uint8_t {
@@ -90,18 +92,32 @@ struct personality {
         std::string str() const;
     };
 
+    // Index of an icon in the gamedata resources, see Game_Dataset::icon
+    using icon_ref = uint16_t;
+    static constexpr icon_ref s_no_icon = UINT16_MAX;
+
     personality() = default;
-    personality(information i, std::string name, std::string description, const std::string* icon1,
-                const std::string* icon2);
+    personality(information i, const Game_Dataset* dataset, uint32_t name, uint32_t description, icon_ref main_icon,
+                icon_ref sec_icon);
 
     std::string str() const;
-    std::string get_art_url() const;
+
+    // Built once by the dataset, see Game_Dataset::embed_template
+    std::string_view art_url() const;
+    const dpp::embed& embed_template() const;
+
+    // Views into the string arena of the dataset, valid as long as the dataset
+    std::string_view name() const;
+    std::string_view description() const;
+    std::string_view main_icon() const;
+    std::string_view sec_icon() const;
 
     information info;   // reminder: keep member order equal to ctor init list for move
-    std::string name;
-    std::string description;
-    const std::string* main_icon;
-    const std::string* sec_icon;
+    const Game_Dataset* dataset{nullptr};
+    uint32_t name_ref{};
+    uint32_t description_ref{};
+    icon_ref main_icon_ref{s_no_icon};
+    icon_ref sec_icon_ref{s_no_icon};
 };
 
 struct auction {
@@ -124,29 +140,30 @@ struct auction {
 };
 
 struct active_auction : public auction {
-    active_auction(const auction& au, std::chrono::system_clock::time_point server_time, const personality* p)
-        : auction(au), ends_at(server_time + au.end_time), p(p) {}
+    active_auction(const auction& au, std::chrono::system_clock::time_point server_time,
+                   std::shared_ptr<const personality> p)
+        : auction(au), ends_at(server_time + au.end_time), p(std::move(p)) {}
 
-    bool has_ended() { return std::chrono::system_clock::now() > ends_at; }
-    bool has_interval_timer(int interval) { return timers_.find(interval) != timers_.end(); }
-    std::chrono::system_clock::time_point client_ends_at() { return ends_at - auction::s_discord_extra_delay; }
+    bool has_ended() const { return std::chrono::system_clock::now() > ends_at; }
+    bool has_interval_timer(int interval) const { return timers_.find(interval) != timers_.end(); }
+    std::chrono::system_clock::time_point client_ends_at() const { return ends_at - auction::s_discord_extra_delay; }
 
-    std::chrono::system_clock::duration time_left() {
+    std::chrono::system_clock::duration time_left() const {
         return std::chrono::abs(ends_at - std::chrono::system_clock::now());
     }
 
-    std::chrono::system_clock::duration wait_delay_for_interval(int interval) {
+    std::chrono::system_clock::duration wait_delay_for_interval(int interval) const {
         return std::chrono::abs(time_left() - std::chrono::minutes{interval} - auction::s_discord_extra_delay);
     }
 
-    std::chrono::system_clock::duration end_time_for_alert() {
+    std::chrono::system_clock::duration end_time_for_alert() const {
         return std::chrono::abs(end_time - auction::s_discord_extra_delay);
     }
 
-    bool expired_for_interval(int interval) { return time_left() < std::chrono::minutes{interval}; }
+    bool expired_for_interval(int interval) const { return time_left() < std::chrono::minutes{interval}; }
 
     std::chrono::system_clock::time_point ends_at;
-    const personality* p;
+    std::shared_ptr<const personality> p;   // keeps the gamedata version it came from alive
     std::unordered_map<int, dpp::timer> timers_;
 };
 
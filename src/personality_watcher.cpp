@@ -1,15 +1,15 @@
 
 #include <algorithm>
 #include <functional>
-#include <future>
 #include <memory>
 #include <time.h>
 #include <vector>
 
 #include "alert_manager.h"
 #include "gamedata.h"
+#include "gamedata_registry.h"
 #include "logger.h"
-#include "lucyapi.h"
+#include "metrics.h"
 #include "personality_watcher.h"
 #include "util.h"
 
@@ -21,38 +21,66 @@ using json = nlohmann::json;
 /// ---------------------------------------- PUBLIC ---------------------------------------
 #pragma region PUBLIC
 
-personality_watcher::personality_watcher(dpp::cluster* bot, GameData* g, Alert_Manager* al_mn)
-    : bot_(bot), gamedata(g), alert_manager_(al_mn), watching_(false), sent_msgs_(bot) {}
+personality_watcher::personality_watcher(dpp::cluster* bot, GameData_Registry* g, Alert_Manager* al_mn,
+                                         std::string world)
+    : bot_(bot), registry_(g), world_(std::move(world)), alert_manager_(al_mn), watching_(false), sent_msgs_(bot) {
+    static constexpr const char* s_http_help = "Latency of the game API requests";
+    static constexpr const char* s_stage_help = "Time spent in each stage of a personality poll";
+    static constexpr std::array<const char*, s_poll_outcomes> s_outcomes{"new", "empty", "failed", "error"};
+
+    stage_latency_ = {
+        &metrics.histogram("lucy_http_request_seconds", s_http_help, {{"endpoint", "personality"}, {"world", world_}}),
+        &metrics.histogram("lucy_parse_seconds", "Time to decode the game API responses",
+                           {{"payload", "personalities"}, {"world", world_}}),
+        &metrics.histogram("lucy_poll_stage_seconds", s_stage_help, {{"stage", "diff"}, {"world", world_}}),
+        &metrics.histogram("lucy_poll_stage_seconds", s_stage_help, {{"stage", "render"}, {"world", world_}}),
+        &metrics.histogram("lucy_poll_stage_seconds", s_stage_help, {{"stage", "dispatch"}, {"world", world_}}),
+    };
+    for (size_t i = 0; i < s_poll_outcomes; ++i) {
+        polls_[i] = &metrics.counter("lucy_polls_total", "Personality polls by outcome",
+                                     {{"outcome", s_outcomes[i]}, {"world", world_}});
+    }
+    sync_latency_ = &metrics.histogram("lucy_http_request_seconds", s_http_help,
+                                       {{"endpoint", "sync_time"}, {"world", world_}});
+
+    metrics.gauge_fn(
+        "lucy_watching", "1 while the personality watcher runs", {{"world", world_}},
+        [this]() { return watching_.load() ? 1.0 : 0.0; }, this);
+    metrics.gauge_fn(
+        "lucy_tracked_messages", "Sent messages waiting for their deletion", {{"owner", "watcher"}, {"world", world_}},
+        [this]() { return static_cast<double>(sent_msgs_.size()); }, this);
+}
 
 personality_watcher::~personality_watcher() {
-    watching_.store(false);
-
-    if (personality_thread_.joinable()) {
-        cv_.notify_one();
-        personality_thread_.join();
-    }
+    metrics.remove(this);
+    stop();
 }
 
 void personality_watcher::run() {
-    std::lock_guard<std::mutex> lock{mtx_};
-    if (!watching_.load()) {
-        logger->debug("Starting personality watcher thread");
+    {
+        std::lock_guard<std::mutex> lock{mtx_};
+        if (watching_.load() || !finished_) {
+            return;
+        }
+
+        logger->debug("Starting personality watcher for world {}, game mode {}", world_, game_mode_);
+        gamedata = registry_->get(game_mode_);
         watching_.store(true);
-        personality_thread_ = std::thread(&personality_watcher::personality_update, this);
+        finished_ = false;
     }
+
+    watch(this);   // runs here until its first co_await
 }
 
 void personality_watcher::stop() {
     std::unique_lock<std::mutex> lock{mtx_};
     if (watching_.load()) {
-        logger->debug("Stopping personality watcher thread");
+        logger->debug("Stopping personality watcher for world {}", world_);
         watching_.store(false);
-        if (personality_thread_.joinable()) {
-            cv_.notify_one();
-            lock.unlock();   // avoid dead lock, the other thread might try locking this mutex
-            personality_thread_.join();
-        }
     }
+
+    // the coroutine notices within s_stop_check or once its request returns
+    cv_.wait(lock, [this]() { return finished_; });
 }
 
 bool personality_watcher::is_watching() {
@@ -65,10 +93,23 @@ bool personality_watcher::is_watching() {
 /// ---------------------------------------- PRIVATE ---------------------------------------
 #pragma region PRIVATE
 
-void personality_watcher::personality_update() {
-    logger->debug("Personality thread started");
+dpp::job personality_watcher::watch(personality_watcher* self) {
+    try {
+        co_await self->personality_update();
+    } catch (const std::exception& e) {
+        logger->error("Personality watcher failed with: {}", e.what());
+        self->watching_.store(false);
+    }
+
+    std::lock_guard<std::mutex> lock{self->mtx_};
+    self->finished_ = true;
+    self->cv_.notify_all();
+}
+
+dpp::task<void> personality_watcher::personality_update() {
+    logger->debug("Personality watcher started");
 
-    if (use_local_time_ || !sync_time()) {
+    if (use_local_time_ || !co_await sync_time()) {
         logger->warn("Using local system time");
         do_sync_time(system_clock::now(), steady_clock::now());
     }
@@ -76,47 +117,56 @@ void personality_watcher::personality_update() {
     int errors_ = 0;
     while (watching_.load()) {
         if (errors_ >= s_max_tries) {
-            logger->warn("Failed to update personalities {} times, stopping thread..", s_max_tries);
+            logger->warn("Failed to update personalities of {} {} times, stopping watcher..", world_, s_max_tries);
             watching_.store(false);
             continue;
         }
 
-        auto request_success = request_auctions();
-        if (!request_success) {
+        auto auctions = decode_auctions(co_await fetch_auctions());
+        if (!auctions) {
+            count(Poll::failed);
             ++errors_;
-            std::unique_lock<std::mutex> lock(mtx_);
             logger->warn("Update personalities failed before, waiting 30 seconds before next try..");
-            cv_.wait_for(lock, seconds{30}, [this]() { return !watching_.load(); });
+            co_await sleep(seconds{30});
             continue;
         } else {
             errors_ = 0;
         }
 
+        std::vector<Outbound> outbound;
         try {
-            process_auctions(*request_success);
+            auto fresh = diff_auctions(*auctions);
+            count(fresh.empty() ? Poll::empty : Poll::fresh);
+            outbound = render_auctions(fresh);
         } catch (const std::exception& e) {
+            count(Poll::error);
             logger->error("Something went wrong while processing auctions: {}", e.what());
             watching_.store(false);
             continue;
         }
 
-        wait();
+        for (auto& out : outbound) {
+            co_await enqueue(std::move(out));
+        }
+        log_stage_latency();
+
+        co_await wait();
         alert_manager_->refresh_active_auctions();
     }
 
-    reset();
-    logger->debug("Personality thread finished");
+    co_await reset();
+    logger->debug("Personality watcher finished");
 }
 
-std::optional<std::vector<auction>> personality_watcher::request_auctions() {
-    auto response = util::request(api_endpoints.at(api::personality_id), s_request_auction_timeout);
+dpp::task<std::string> personality_watcher::fetch_auctions() {
+    Scoped_Timer timing{latency(Stage::fetch)};
+    co_return co_await util::co_request(bot_, personality_url_, s_request_auction_timeout);
+}
 
+std::optional<std::vector<auction>> personality_watcher::decode_auctions(const std::string& body) {
+    Scoped_Timer timing{latency(Stage::decode)};
     try {
-        return nlohmann::json::parse(response)
-            .at("Body")
-            .at("Personalities")
-            .at("auctions")
-            .get<std::vector<auction>>();
+        return nlohmann::json::parse(body).at("Body").at("Personalities").at("auctions").get<std::vector<auction>>();
     } catch (const json::exception& e) {
         logger->warn("Parsing personalities json failed with: {}", e.what());
     } catch (const std::exception& e) {
@@ -126,7 +176,8 @@ std::optional<std::vector<auction>> personality_watcher::request_auctions() {
     return {};
 }
 
-void personality_watcher::process_auctions(std::vector<auction>& auctions) {
+std::vector<active_auction> personality_watcher::diff_auctions(std::vector<auction>& auctions) {
+    Scoped_Timer timing{latency(Stage::diff)};
     std::sort(auctions.begin(), auctions.end(),
               [](const auction& a, const auction& b) { return a.end_time < b.end_time; });
 
@@ -145,6 +196,7 @@ void personality_watcher::process_auctions(std::vector<auction>& auctions) {
         return v;
     }();
 
+    std::vector<active_auction> fresh;
     if (new_auctions.empty()) {
         // wait until next hour fifth minute
         auto left_to_next_hr = util::left_to_next_hour(system_clock::now()) + auction::s_request_wait;
@@ -157,48 +209,111 @@ void personality_watcher::process_auctions(std::vector<auction>& auctions) {
             wait_times_.front() = left_to_next_hr;
         }
 
-        return;
+        return fresh;
     }
 
     auto server_time = server_time_now();
     for (auto&& au : new_auctions) {
-        active_auction new_active_auction{*au, server_time, &gamedata->get_personality(au->personality_id)};
+        auto p = gamedata->get_personality(au->personality_id);
+        if (!p) {
+            // retried on the next poll, once the requested gamedata refresh had a chance to add it
+            logger->warn("Skipping auction {}, personality {} is not in the gamedata", au->id, au->personality_id);
+            alert_manager_->forget_seen_auction_id(au->id);
+            continue;
+        }
+
+        active_auction& new_active_auction = fresh.emplace_back(*au, server_time, std::move(p));
         add_wait_time(&new_active_auction);
         alert_manager_->add_active_auction(new_active_auction);
+    }
 
-        auto type = new_active_auction.p->info.ptype;
-        if (active_only_horizon_msg_ && !alert_manager_->is_alert_enabled(type)) {
-            continue;
+    return fresh;
+}
+
+std::vector<personality_watcher::Outbound>
+personality_watcher::render_auctions(const std::vector<active_auction>& fresh) {
+    Scoped_Timer timing{latency(Stage::render)};
+    std::vector<Outbound> outbound;
+
+    for (const auto& au : fresh) {
+        auto type = au.p->info.ptype;
+        if (alert_manager_->board_enabled() ||
+            (active_only_horizon_msg_ && !alert_manager_->is_alert_enabled(type))) {
+            continue;   // the board lists it instead of a horizon message
         }
 
         dpp::message msg;
         msg.channel_id = alert_manager_->get_alert_channel();
-        auto e = util::build_embed(new_active_auction.client_ends_at(), *new_active_auction.p, true);
+        auto e = util::build_embed(au.client_ends_at(), *au.p, true);
         if (alert_manager_->has_horizon_message(type)) {
             e.add_field("", alert_manager_->get_horizon_message(type));
         }
         msg.add_embed(e);
 
-        send_discord_msg(msg, new_active_auction.end_time_for_alert());
+        outbound.push_back(Outbound{std::move(msg), au.end_time_for_alert()});
+    }
+
+    return outbound;
+}
+
+dpp::task<void> personality_watcher::enqueue(Outbound out) {
+    while (!outbox_.push(std::move(out))) {
+        logger->debug("Outbox full, waiting for dispatch");
+        co_await bot_->co_sleep(1);
+    }
+
+    if (!dispatching_.exchange(true)) {
+        dispatch(this);
     }
 }
 
-bool personality_watcher::sync_time() {
+dpp::job personality_watcher::dispatch(personality_watcher* self) {
+    do {
+        while (auto out = self->outbox_.pop()) {
+            Scoped_Timer timing{self->latency(Stage::dispatch)};
+            auto cc = co_await self->bot_->co_message_create(out->msg);
+            if (cc.is_error()) {
+                logger->warn("Bot failed to create personality message: {}", cc.get_error().message);
+                continue;
+            }
+
+            const dpp::message& m = cc.get<dpp::message>();
+            self->sent_msgs_.add_message(m.id, m.channel_id);
+            util::one_shot_timer(
+                self->bot_, [msg_id = m.id, s = &self->sent_msgs_]() { s->delete_message(msg_id, "(non alert)"); },
+                static_cast<uint64_t>(duration_cast<seconds>(out->wait_delete).count()) +
+                    MessageTracker::s_delete_message_delay);
+        }
+
+        self->dispatching_.store(false);
+        std::atomic_thread_fence(std::memory_order_seq_cst);   // against a push between the last pop and the store
+    } while (!self->outbox_.empty() && !self->dispatching_.exchange(true));
+}
+
+void personality_watcher::log_stage_latency() {
+    static constexpr std::array<const char*, s_stage_count> s_names{"fetch", "decode", "diff", "render", "dispatch"};
+    for (size_t i = 0; i < s_stage_count; ++i) {
+        logger->debug("Stage {}: {}", s_names[i], stage_latency_[i]->summary());
+    }
+}
+
+dpp::task<bool> personality_watcher::sync_time() {
     auto request_time = steady_clock::now();
-    auto response = util::request(api_endpoints.at(api::sync_time_id), s_sync_time_timeout);
+    auto response = co_await util::co_request(bot_, sync_time_url_, s_sync_time_timeout);
+    sync_latency_->record(steady_clock::now() - request_time);
     uint64_t s{};
     try {
         s = json::parse(response).at("Body").get<std::uint64_t>();
     } catch (const json::exception& e) {
         logger->warn("Parsing sync_time json failed with: {}", e.what());
-        return false;
+        co_return false;
     } catch (const std::exception& e) {
         logger->warn("sync_time failed with: {}", e.what());
-        return false;
+        co_return false;
     }
 
     do_sync_time(system_clock::time_point{seconds{s}}, request_time);
-    return true;
+    co_return true;
 }
 
 void personality_watcher::do_sync_time(system_clock::time_point server_time, steady_clock::time_point request_time) {
@@ -218,14 +333,12 @@ void personality_watcher::add_wait_time(active_auction* au) {
     auto already_waited = std::accumulate(
         wait_times_.begin(), wait_times_.end(), system_clock::duration{0}, std::plus<system_clock::duration>{});
     auto to_wait = std::chrono::abs(au->end_time - already_waited + auction::s_request_wait);
-    logger->debug("Add Wait: {} offset: {}, to wait {}", au->p->name, util::fmt_to_hr_min_sec(already_waited),
+    logger->debug("Add Wait: {} offset: {}, to wait {}", au->p->name(), util::fmt_to_hr_min_sec(already_waited),
                   util::fmt_to_hr_min_sec(to_wait));
     wait_times_.push_back(to_wait);
 }
 
-void personality_watcher::wait() {
-    std::unique_lock<std::mutex> lock(mtx_);
-
+dpp::task<void> personality_watcher::wait() {
     const auto empty_waits = [&]() {
         auto to_wait = util::left_to_next_hour(system_clock::now()) + auction::s_request_wait;
         logger->debug("Waiting times were empty, waiting {} next hour", util::fmt_to_hr_min_sec(to_wait));
@@ -239,7 +352,15 @@ void personality_watcher::wait() {
     }();
 
     logger->debug("Waiting: {}", util::fmt_to_hr_min_sec(w));
-    cv_.wait_for(lock, w, [this]() { return !watching_.load(); });   // if not running on spurious wakeup stop waiting
+    co_await sleep(w);
+}
+
+dpp::task<void> personality_watcher::sleep(system_clock::duration d) {
+    const auto until = steady_clock::now() + d;
+    while (watching_.load() && steady_clock::now() < until) {
+        auto left = duration_cast<seconds>(until - steady_clock::now()).count();
+        co_await bot_->co_sleep(static_cast<uint64_t>(std::clamp<int64_t>(left, 1, s_stop_check)));
+    }
 }
 
 system_clock::time_point personality_watcher::server_time_now() {
@@ -247,26 +368,14 @@ system_clock::time_point personality_watcher::server_time_now() {
            duration_cast<system_clock::duration>(std::chrono::abs(steady_clock::now() - at_sync_time_));
 }
 
-void personality_watcher::send_discord_msg(const dpp::message& msg, system_clock::duration wait_delete) {
-    bot_->message_create(msg, [this, wait_delete](const dpp::confirmation_callback_t& cc) {
-        if (cc.is_error()) {
-            logger->warn("Bot failed to create personality message: {}", cc.get_error().message);
-            return;
-        }
-
-        const dpp::message& m = cc.get<dpp::message>();
-        sent_msgs_.add_message(m.id, m.channel_id);
-        util::one_shot_timer(
-            bot_, [msg_id = m.id, s = &sent_msgs_]() { s->delete_message(msg_id, "(non alert)"); },
-            static_cast<uint64_t>(duration_cast<seconds>(wait_delete).count()) +
-                MessageTracker::s_delete_message_delay);
-    });
-}
-
-void personality_watcher::reset() {
+dpp::task<void> personality_watcher::reset() {
+    gamedata.reset();   // let the registry evict the mode
     wait_times_.clear();
     alert_manager_->reset_alerts();
-    sent_msgs_.delete_all_messages(true);
+    while (dispatching_.load()) {   // let the queued messages go out so they are deleted below
+        co_await bot_->co_sleep(1);
+    }
+    co_await sent_msgs_.co_delete_all_messages();
 }
 
 #pragma endregion PRIVATE
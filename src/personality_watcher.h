@@ -1,29 +1,34 @@
 #ifndef PERSONALITY_WATCHER_H
 #define PERSONALITY_WATCHER_H
 
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <deque>
+#include <memory>
 #include <mutex>
 #include <optional>
-#include <thread>
+#include <string>
 #include <vector>
 
 #include <dpp/dpp.h>
 
 #include "message_tracker.h"
+#include "metrics.h"
 #include "personality.h"
+#include "spsc_queue.h"
 
 namespace railcord {
 
 class GameData;
+class GameData_Registry;
 class Alert_Info;
 class Alert_Manager;
 
 class personality_watcher {
   public:
-    personality_watcher(dpp::cluster* bot, GameData* g, Alert_Manager* al_m);
+    personality_watcher(dpp::cluster* bot, GameData_Registry* g, Alert_Manager* al_m, std::string world);
     personality_watcher() = delete;
     personality_watcher(const personality_watcher&) = delete;
     personality_watcher(personality_watcher&&) = delete;
@@ -37,34 +42,74 @@ class personality_watcher {
     void set_active_only_horizon_msg(bool enabled) { active_only_horizon_msg_ = enabled; }
     bool active_only_horizon_msg() { return active_only_horizon_msg_; }
 
+    // Takes effect on the next run
+    const std::string& game_mode() { return game_mode_; }
+    void set_game_mode(const std::string& game_mode) { game_mode_ = game_mode; }
+    void set_endpoints(std::string personality_url, std::string sync_time_url) {
+        personality_url_ = std::move(personality_url);
+        sync_time_url_ = std::move(sync_time_url);
+    }
+
+    const std::string& world() { return world_; }   // labels its logs and metrics
+
     bool is_using_local_time() { return use_local_time_; }
     void set_using_local_time(bool use_local_time) { use_local_time_ = use_local_time; }
 
-    static constexpr int s_request_auction_timeout = 90;   // seconds
-    static constexpr int s_sync_time_timeout = 90;         // seconds
+    // Stages of a poll. fetch to render run in the watch coroutine, dispatch drains outbox_ in its own so sending
+    // overlaps the next poll
+    enum class Stage : uint8_t { fetch, decode, diff, render, dispatch };
+    static constexpr size_t s_stage_count = 5;
+    const Histogram& stage_latency(Stage s) const { return *stage_latency_[static_cast<size_t>(s)]; }
+
+    enum class Poll : uint8_t { fresh, empty, failed, error };   // new auctions, none new, request failed, threw
+    static constexpr size_t s_poll_outcomes = 4;
+
     static constexpr int s_max_tries = 5;
+    static constexpr uint16_t s_request_auction_timeout = 90;   // seconds
+    static constexpr uint16_t s_sync_time_timeout = 90;         // seconds
+    static constexpr uint64_t s_stop_check = 2;   // seconds, waits are slept in slices of this to notice stop()
 
   private:
-    void personality_update();
-    std::optional<std::vector<auction>> request_auctions();
-    void process_auctions(std::vector<auction>& auctions);
-
-    bool sync_time();
+    // The watch loop is a coroutine resumed by the cluster's timers and HTTP client, it holds no thread while idle
+    static dpp::job watch(personality_watcher* self);
+    dpp::task<void> personality_update();
+
+    struct Outbound {
+        dpp::message msg;
+        std::chrono::system_clock::duration wait_delete;
+    };
+
+    dpp::task<std::string> fetch_auctions();
+    std::optional<std::vector<auction>> decode_auctions(const std::string& body);
+    std::vector<active_auction> diff_auctions(std::vector<auction>& auctions);   // registers the new ones
+    std::vector<Outbound> render_auctions(const std::vector<active_auction>& fresh);
+    dpp::task<void> enqueue(Outbound out);   // waits while outbox_ is full
+    static dpp::job dispatch(personality_watcher* self);
+    Histogram& latency(Stage s) { return *stage_latency_[static_cast<size_t>(s)]; }
+    void count(Poll p) { polls_[static_cast<size_t>(p)]->inc(); }
+    void log_stage_latency();
+
+    dpp::task<bool> sync_time();
     void do_sync_time(std::chrono::system_clock::time_point server_time,
                       std::chrono::steady_clock::time_point request_time);
     void add_wait_time(active_auction* au);
-    void wait();
+    dpp::task<void> wait();
+    dpp::task<void> sleep(std::chrono::system_clock::duration d);   // returns early once stopped
     std::chrono::system_clock::time_point server_time_now();
 
-    void send_discord_msg(const dpp::message& msg, std::chrono::system_clock::duration wait_delete);
-    void reset();
+    dpp::task<void> reset();
 
     dpp::cluster* bot_;
-    GameData* gamedata;
+    GameData_Registry* registry_;
+    std::string game_mode_{"classic"};
+    std::string world_;
+    std::string personality_url_;
+    std::string sync_time_url_;
+    std::shared_ptr<GameData> gamedata;   // held while watching
     Alert_Manager* alert_manager_;
 
     std::atomic_bool watching_;
-    std::thread personality_thread_;
+    bool finished_{true};   // the watch coroutine returned, with mtx_
     std::condition_variable cv_;
     std::mutex mtx_;
 
@@ -76,6 +121,12 @@ class personality_watcher {
 
     std::deque<std::chrono::system_clock::duration> wait_times_;
     MessageTracker sent_msgs_;
+
+    Spsc_Queue<Outbound, 16> outbox_;   // the watch coroutine produces, one dispatch job at a time consumes
+    std::atomic_bool dispatching_{false};
+    std::array<Histogram*, s_stage_count> stage_latency_;   // in metrics
+    std::array<Counter*, s_poll_outcomes> polls_;
+    Histogram* sync_latency_;
 };
 }   // namespace railcord
 
@@ -0,0 +1,51 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <utility>
+
+namespace railcord {
+
+// Bounded lock free ring for exactly one producer and one consumer thread at a time
+template <typename T, size_t N>
+class Spsc_Queue {
+    static_assert(N && (N & (N - 1)) == 0, "capacity must be a power of two");
+
+  public:
+    template <typename U>
+    bool push(U&& value) {   // false when full, value is left untouched then
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) == N) {
+            return false;
+        }
+        slots_[tail & (N - 1)] = std::forward<U>(value);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    std::optional<T> pop() {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) {
+            return {};
+        }
+        std::optional<T> value{std::move(slots_[head & (N - 1)])};
+        slots_[head & (N - 1)] = T{};
+        head_.store(head + 1, std::memory_order_release);
+        return value;
+    }
+
+    bool empty() const { return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire); }
+    static constexpr size_t capacity() { return N; }
+
+  private:
+    std::array<T, N> slots_{};
+    alignas(64) std::atomic<size_t> head_{0};   // next to pop
+    alignas(64) std::atomic<size_t> tail_{0};   // next to push
+};
+
+}   // namespace railcord
+
+#endif   // !SPSC_QUEUE_H
@@ -0,0 +1,220 @@
+#include <algorithm>
+
+#include <dpp/unicode_emoji.h>
+#include <fmt/format.h>
+
+#include "logger.h"
+#include "status_board.h"
+#include "util.h"
+
+namespace railcord {
+
+using namespace std::chrono;
+using json = nlohmann::json;
+
+static constexpr uint32_t s_unknown_message_error = 10008;
+
+/// ---------------------------------------- PUBLIC ---------------------------------------
+#pragma region PUBLIC
+
+Status_Board::Status_Board(dpp::cluster* bot, Snapshot snapshot)
+    : bot_(bot), snapshot_(std::move(snapshot)), token_(std::make_shared<Token>(this)) {}
+
+Status_Board::~Status_Board() {
+    {
+        // waits for a running callback, the later ones see the board is gone
+        std::lock_guard<std::mutex> token_lock{token_->mtx};
+        token_->board = nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock{mtx_};
+    if (pending_) {
+        bot_->stop_timer(debounce_timer_);
+    }
+}
+
+bool Status_Board::is_enabled() {
+    std::lock_guard<std::mutex> lock{mtx_};
+    return enabled_;
+}
+
+void Status_Board::set_enabled(bool enabled) {
+    std::lock_guard<std::mutex> lock{mtx_};
+    enabled_ = enabled;
+    if (enabled_) {
+        schedule_flush();
+    }
+}
+
+void Status_Board::set_channel(dpp::snowflake channel) {
+    std::lock_guard<std::mutex> lock{mtx_};
+    if (channel_ == channel) {
+        return;
+    }
+
+    if (!message_id_.empty()) {
+        logger->info("Board channel changed, deleting old board id={}", static_cast<uint64_t>(message_id_));
+        bot_->message_delete(message_id_, channel_);
+    }
+
+    channel_ = channel;
+    message_id_ = {};
+    last_render_.clear();
+
+    if (enabled_) {
+        schedule_flush();
+    }
+}
+
+void Status_Board::request_update() {
+    std::lock_guard<std::mutex> lock{mtx_};
+    if (enabled_) {
+        schedule_flush();
+    }
+}
+
+json Status_Board::save() {
+    std::lock_guard<std::mutex> lock{mtx_};
+    return {{"channel", static_cast<uint64_t>(channel_)}, {"message", static_cast<uint64_t>(message_id_)}};
+}
+
+void Status_Board::load(const json& j) {
+    std::lock_guard<std::mutex> lock{mtx_};
+    dpp::snowflake channel = j.at("channel").get<uint64_t>();
+
+    // the saved board is only reused if it lives in the current alert channel
+    if (channel == channel_) {
+        message_id_ = j.at("message").get<uint64_t>();
+    }
+}
+
+#pragma endregion PUBLIC
+
+/// ---------------------------------------- PRIVATE ---------------------------------------
+#pragma region PRIVATE
+
+template <typename Fn>
+auto Status_Board::guarded(Fn fn) const {
+    return [token = token_, fn = std::move(fn)](auto&&... args) {
+        std::lock_guard<std::mutex> lock{token->mtx};
+        if (token->board) {
+            fn(std::forward<decltype(args)>(args)...);
+        }
+    };
+}
+
+void Status_Board::schedule_flush() {
+    if (pending_) {
+        return;
+    }
+
+    pending_ = true;
+    debounce_timer_ = util::one_shot_timer(
+        bot_, guarded([this]() { flush(); }), s_debounce_seconds);
+}
+
+void Status_Board::flush() {
+    // the snapshot takes the alert manager lock, never hold ours while calling it
+    auto entries = snapshot_();
+
+    std::lock_guard<std::mutex> lock{mtx_};
+    pending_ = false;
+
+    if (!enabled_ || channel_.empty()) {
+        return;
+    }
+
+    if (creating_) {   // wait for the board id before editing
+        schedule_flush();
+        return;
+    }
+
+    dpp::message m = render(entries);
+    std::string rendered = m.build_json();
+    if (rendered == last_render_ && !message_id_.empty()) {
+        return;
+    }
+    last_render_ = std::move(rendered);
+
+    if (message_id_.empty()) {
+        create_board(m);
+        return;
+    }
+
+    m.id = message_id_;
+    bot_->message_edit(m, guarded([this, m](const dpp::confirmation_callback_t& cc) {
+        if (!cc.is_error()) {
+            return;
+        }
+
+        const auto& err = cc.get_error();
+        logger->warn("Failed to edit board message: {}", err.message);
+        if (err.code == s_unknown_message_error) {
+            std::lock_guard<std::mutex> lock{mtx_};
+            if (message_id_ == m.id) {
+                message_id_ = {};
+                create_board(m);
+            }
+        }
+    }));
+}
+
+dpp::message Status_Board::render(const std::vector<Board_Entry>& entries) {
+    dpp::embed e;
+    e.set_title("Active auctions");
+
+    if (entries.empty()) {
+        e.set_description("No active auctions");
+    } else {
+        std::string desc;
+        desc.reserve(entries.size() * 128);
+        for (const auto& entry : entries) {
+            desc.append(entry.alert_enabled ? dpp::unicode_emoji::bell : dpp::unicode_emoji::no_bell)
+                .append(" **")
+                .append(entry.p->name())
+                .append("** ")
+                .append(util::timepoint_to_discord_timestamp(entry.ends_at))
+                .append(" (")
+                .append(util::timepoint_to_discord_timestamp(entry.ends_at, "t"))
+                .append(")\n")
+                .append(entry.p->info.ptype.description())
+                .append("\n");
+
+            if (!entry.horizon_msg.empty()) {
+                desc.append("> ").append(entry.horizon_msg).append("\n");
+            }
+        }
+        e.set_description(desc);
+    }
+
+    dpp::message m;
+    m.set_channel_id(channel_);
+    m.add_embed(e);
+    return m;
+}
+
+void Status_Board::create_board(const dpp::message& m) {
+    creating_ = true;
+    dpp::message msg{m};
+    msg.id = {};
+
+    bot_->message_create(msg, guarded([this](const dpp::confirmation_callback_t& cc) {
+        std::lock_guard<std::mutex> lock{mtx_};
+        creating_ = false;
+
+        if (cc.is_error()) {
+            logger->warn("Failed to create board message: {}", cc.get_error().message);
+            last_render_.clear();
+            return;
+        }
+
+        const auto& created = cc.get<dpp::message>();
+        message_id_ = created.id;
+        logger->info("Created board message id={}", static_cast<uint64_t>(message_id_));
+        bot_->message_pin(created.channel_id, created.id);
+    }));
+}
+
+#pragma endregion PRIVATE
+
+}   // namespace railcord
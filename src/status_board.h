@@ -0,0 +1,85 @@
+#ifndef STATUS_BOARD_H
+#define STATUS_BOARD_H
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// clang-format off
+#include <dpp/json.h>
+// clang-format on
+
+#include <dpp/dpp.h>
+
+#include "personality.h"
+
+namespace railcord {
+
+struct Board_Entry {
+    std::shared_ptr<const personality> p;
+    std::chrono::system_clock::time_point ends_at;
+    bool alert_enabled;
+    std::string horizon_msg;
+};
+
+// A single pinned message per channel listing the active auctions, edited in place.
+// Relative discord timestamps keep it current, so it is only edited when the listed data changes
+class Status_Board {
+  public:
+    using Snapshot = std::function<std::vector<Board_Entry>()>;
+
+    Status_Board(dpp::cluster* bot, Snapshot snapshot);
+    Status_Board(const Status_Board&) = delete;
+    Status_Board(Status_Board&&) = delete;
+    Status_Board& operator=(const Status_Board&) = delete;
+    Status_Board& operator=(Status_Board&&) = delete;
+    ~Status_Board();
+
+    bool is_enabled();
+    void set_enabled(bool enabled);
+    void set_channel(dpp::snowflake channel);
+
+    // Debounced, every request within s_debounce_seconds results in one edit
+    void request_update();
+
+    nlohmann::json save();
+    void load(const nlohmann::json& j);
+
+    static constexpr uint64_t s_debounce_seconds = 5;
+
+  private:
+    // Shared with the debounce timer and the REST callbacks in flight. They run holding its mutex and do nothing once
+    // the destructor cleared board
+    struct Token {
+        explicit Token(Status_Board* b) : board(b) {}
+        std::mutex mtx;
+        Status_Board* board;
+    };
+
+    template <typename Fn>
+    auto guarded(Fn fn) const;   // fn only runs while the board exists
+    void schedule_flush();
+    void flush();
+    dpp::message render(const std::vector<Board_Entry>& entries);
+    void create_board(const dpp::message& m);
+
+    dpp::cluster* bot_;
+    Snapshot snapshot_;
+    std::shared_ptr<Token> token_;
+    std::mutex mtx_;
+
+    bool enabled_{false};
+    bool pending_{false};
+    bool creating_{false};
+    dpp::timer debounce_timer_{};
+    dpp::snowflake channel_;
+    dpp::snowflake message_id_;
+    std::string last_render_;
+};
+
+}   // namespace railcord
+
+#endif   // !STATUS_BOARD_H
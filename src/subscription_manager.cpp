@@ -0,0 +1,216 @@
+#include <algorithm>
+
+#include "alert_info.h"
+#include "logger.h"
+#include "subscription_manager.h"
+
+namespace railcord {
+
+using json = nlohmann::json;
+
+void User_Bitset::set(uint32_t idx, bool value) {
+    size_t word = idx / 64;
+    uint64_t mask = uint64_t{1} << (idx % 64);
+
+    if (word >= words_.size()) {
+        if (!value) {
+            return;
+        }
+        words_.resize(word + 1, 0);
+    }
+
+    if (value) {
+        words_[word] |= mask;
+    } else {
+        words_[word] &= ~mask;
+    }
+}
+
+bool User_Bitset::test(uint32_t idx) const {
+    size_t word = idx / 64;
+    return word < words_.size() && (words_[word] >> (idx % 64)) & 1u;
+}
+
+bool User_Bitset::any() const {
+    return std::any_of(words_.begin(), words_.end(), [](uint64_t w) { return w != 0; });
+}
+
+/// ---------------------------------------- PUBLIC ---------------------------------------
+#pragma region PUBLIC
+
+Subscription_Manager::Subscription_Manager(dpp::cluster* bot)
+    : bot_(bot), subscribers_(personality::type::unknown * Alert_Info::s_intervals.size()) {}
+
+Subscription_Manager::~Subscription_Manager() {
+    std::lock_guard<std::mutex> lock{mtx_};
+    if (pacing_) {
+        bot_->stop_timer(pacing_timer_);
+    }
+}
+
+bool Subscription_Manager::subscribe(dpp::snowflake user, personality::type t, int interval, bool enabled) {
+    std::lock_guard<std::mutex> lock{mtx_};
+    User_Bitset* bits = find_bits(t, interval);
+    if (!bits) {
+        logger->warn("Invalid subscription type={} interval={}", t.t, interval);
+        return false;
+    }
+
+    if (!enabled) {
+        // an unknown user has nothing to clear, don't give them an index
+        auto idx = user_idx_.find(user);
+        if (idx != user_idx_.end()) {
+            bits->set(idx->second, false);
+        }
+        return true;
+    }
+
+    bits->set(user_index(user), true);
+    return true;
+}
+
+bool Subscription_Manager::is_subscribed(dpp::snowflake user, personality::type t, int interval) {
+    std::lock_guard<std::mutex> lock{mtx_};
+    auto idx = user_idx_.find(user);
+    const User_Bitset* bits = find_bits(t, interval);
+    return idx != user_idx_.end() && bits && bits->test(idx->second);
+}
+
+bool Subscription_Manager::has_subscribers(personality::type t, int interval) {
+    std::lock_guard<std::mutex> lock{mtx_};
+    const User_Bitset* bits = find_bits(t, interval);
+    return bits && bits->any();
+}
+
+void Subscription_Manager::fan_out(personality::type t, int interval, const dpp::message& msg) {
+    auto payload = std::make_shared<const std::string>(msg.build_json());
+
+    std::lock_guard<std::mutex> lock{mtx_};
+    const User_Bitset* bits = find_bits(t, interval);
+    if (!bits) {
+        return;
+    }
+
+    size_t queued = 0;
+    bits->for_each([&](uint32_t idx) {
+        pending_.push_back({users_[idx], payload});
+        ++queued;
+    });
+
+    logger->debug("Queued {} direct messages for type {} interval {}", queued, t.t, interval);
+
+    if (!pending_.empty() && !pacing_) {
+        pacing_ = true;
+        pacing_timer_ = bot_->start_timer([this](dpp::timer) { drain(); }, 1);
+    }
+}
+
+json Subscription_Manager::save() const {
+    std::lock_guard<std::mutex> lock{mtx_};
+    const size_t intervals = Alert_Info::s_intervals.size();
+    json j = json::array();
+
+    for (size_t i = 0; i < subscribers_.size(); ++i) {
+        std::vector<uint64_t> users;
+        subscribers_[i].for_each([&](uint32_t idx) { users.push_back(static_cast<uint64_t>(users_[idx])); });
+        if (users.empty()) {
+            continue;
+        }
+
+        j.push_back({{"type", i / intervals}, {"interval", Alert_Info::s_intervals[i % intervals]}, {"users", users}});
+    }
+
+    return j;
+}
+
+void Subscription_Manager::load(const json& j) {
+    for (const auto& sub : j) {
+        personality::type t{sub.at("type").get<int>()};
+        int interval = sub.at("interval").get<int>();
+        for (uint64_t user : sub.at("users").get<std::vector<uint64_t>>()) {
+            subscribe(user, t, interval, true);
+        }
+    }
+}
+
+#pragma endregion PUBLIC
+
+/// ---------------------------------------- PRIVATE ---------------------------------------
+#pragma region PRIVATE
+
+uint32_t Subscription_Manager::user_index(dpp::snowflake user) {
+    auto [it, inserted] = user_idx_.try_emplace(user, static_cast<uint32_t>(users_.size()));
+    if (inserted) {
+        users_.push_back(user);
+    }
+    return it->second;
+}
+
+User_Bitset* Subscription_Manager::find_bits(personality::type t, int interval) {
+    return const_cast<User_Bitset*>(static_cast<const Subscription_Manager*>(this)->find_bits(t, interval));
+}
+
+const User_Bitset* Subscription_Manager::find_bits(personality::type t, int interval) const {
+    const auto& intervals = Alert_Info::s_intervals;
+    auto it = std::find(intervals.begin(), intervals.end(), interval);
+    if (t >= personality::type::unknown || it == intervals.end()) {
+        return nullptr;
+    }
+
+    return &subscribers_[t * intervals.size() + static_cast<size_t>(it - intervals.begin())];
+}
+
+void Subscription_Manager::drain() {
+    std::vector<Pending_DM> batch;
+    {
+        std::lock_guard<std::mutex> lock{mtx_};
+        while (!pending_.empty() && batch.size() < s_dm_per_tick) {
+            batch.push_back(std::move(pending_.front()));
+            pending_.pop_front();
+        }
+
+        if (pending_.empty() && pacing_) {
+            bot_->stop_timer(pacing_timer_);
+            pacing_ = false;
+        }
+    }
+
+    for (const auto& dm : batch) {
+        send_dm(dm.user, dm.payload);
+    }
+}
+
+void Subscription_Manager::send_dm(dpp::snowflake user, const std::shared_ptr<const std::string>& payload) {
+    dpp::snowflake channel = bot_->get_dm_channel(user);
+    if (!channel.empty()) {
+        post_dm(channel, user, payload);
+        return;
+    }
+
+    bot_->create_dm_channel(user, [this, user, payload](const dpp::confirmation_callback_t& cc) {
+        if (cc.is_error()) {
+            logger->warn("Failed to open DM channel for user {}: {}", static_cast<uint64_t>(user),
+                         cc.get_error().message);
+            return;
+        }
+
+        const auto& ch = cc.get<dpp::channel>();
+        bot_->set_dm_channel(user, ch.id);
+        post_dm(ch.id, user, payload);
+    });
+}
+
+void Subscription_Manager::post_dm(dpp::snowflake channel, dpp::snowflake user,
+                                   const std::shared_ptr<const std::string>& payload) {
+    bot_->post_rest(API_PATH "/channels", std::to_string(channel), "messages", dpp::m_post, *payload,
+                    [user](json&, const dpp::http_request_completion_t& http) {
+                        if (http.status >= 400) {
+                            logger->warn("Failed to DM alert to user {}, status={}", static_cast<uint64_t>(user),
+                                         http.status);
+                        }
+                    });
+}
+
+#pragma endregion PRIVATE
+
+}   // namespace railcord
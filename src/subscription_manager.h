@@ -0,0 +1,94 @@
+#ifndef SUBSCRIPTION_MANAGER_H
+#define SUBSCRIPTION_MANAGER_H
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// clang-format off
+#include <dpp/json.h>
+// clang-format on
+
+#include <dpp/dpp.h>
+
+#include "personality.h"
+
+namespace railcord {
+
+// One bit per user index, grows on demand
+class User_Bitset {
+  public:
+    void set(uint32_t idx, bool value);
+    bool test(uint32_t idx) const;
+    bool any() const;
+
+    template <typename F>
+    void for_each(F&& f) const {
+        for (size_t w = 0; w < words_.size(); ++w) {
+            uint64_t word = words_[w];
+            for (uint32_t bit = 0; word; ++bit, word >>= 1) {
+                if (word & 1u) {
+                    f(static_cast<uint32_t>(w * 64 + bit));
+                }
+            }
+        }
+    }
+
+  private:
+    std::vector<uint64_t> words_;
+};
+
+// Per user direct message alerts, subscribers are kept as one bitset per (type, interval)
+class Subscription_Manager {
+  public:
+    Subscription_Manager(dpp::cluster* bot);
+    Subscription_Manager(const Subscription_Manager&) = delete;
+    Subscription_Manager(Subscription_Manager&&) = delete;
+    Subscription_Manager& operator=(const Subscription_Manager&) = delete;
+    Subscription_Manager& operator=(Subscription_Manager&&) = delete;
+    ~Subscription_Manager();
+
+    bool subscribe(dpp::snowflake user, personality::type t, int interval, bool enabled);
+    bool is_subscribed(dpp::snowflake user, personality::type t, int interval);
+    bool has_subscribers(personality::type t, int interval);
+
+    // Renders msg once and queues the same payload for every subscriber of (t, interval)
+    void fan_out(personality::type t, int interval, const dpp::message& msg);
+
+    nlohmann::json save() const;
+    void load(const nlohmann::json& j);
+
+    static constexpr unsigned s_dm_per_tick = 10;   // direct messages sent per second
+
+  private:
+    struct Pending_DM {
+        dpp::snowflake user;
+        std::shared_ptr<const std::string> payload;
+    };
+
+    uint32_t user_index(dpp::snowflake user);
+    User_Bitset* find_bits(personality::type t, int interval);
+    const User_Bitset* find_bits(personality::type t, int interval) const;
+    void drain();
+    void send_dm(dpp::snowflake user, const std::shared_ptr<const std::string>& payload);
+    void post_dm(dpp::snowflake channel, dpp::snowflake user, const std::shared_ptr<const std::string>& payload);
+
+    dpp::cluster* bot_;
+    mutable std::mutex mtx_;
+
+    std::vector<dpp::snowflake> users_;                       // index -> user
+    std::unordered_map<dpp::snowflake, uint32_t> user_idx_;   // user -> index
+    std::vector<User_Bitset> subscribers_;                    // [type * intervals + interval index]
+
+    std::deque<Pending_DM> pending_;
+    dpp::timer pacing_timer_{};
+    bool pacing_{false};
+};
+
+}   // namespace railcord
+
+#endif   // !SUBSCRIPTION_MANAGER_H
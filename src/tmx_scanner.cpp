@@ -0,0 +1,200 @@
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+
+#include "logger.h"
+#include "tmx_scanner.h"
+
+namespace railcord {
+
+inline constexpr std::string_view s_common_fmt{"IDS_PERSONALITY_"};
+inline constexpr std::string_view s_name_fmt{"NAME_"};
+inline constexpr std::string_view s_effect_fmt{"EFFECT_"};
+
+static bool is_space(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+static bool starts_with(std::string_view s, std::string_view prefix) { return s.substr(0, prefix.size()) == prefix; }
+
+static bool iequals(std::string_view a, std::string_view b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+               return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+           });
+}
+
+// Value of an attribute in a start tag, "lang" also matches "xml:lang"
+static std::string_view attribute_value(std::string_view tag, std::string_view name) {
+    size_t at = 0;
+    while ((at = tag.find(name, at)) != std::string_view::npos) {
+        const size_t eq = at + name.size();
+        const bool bounded = at > 0 && (is_space(tag[at - 1]) || tag[at - 1] == ':');
+        if (bounded && eq + 1 < tag.size() && tag[eq] == '=' && (tag[eq + 1] == '"' || tag[eq + 1] == '\'')) {
+            const size_t close = tag.find(tag[eq + 1], eq + 2);
+            if (close != std::string_view::npos) {
+                return tag.substr(eq + 2, close - eq - 2);
+            }
+        }
+        at = eq;
+    }
+    return {};
+}
+
+static void append_utf8(std::string& out, uint32_t cp) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+Tmx_Strings Tmx_Strings::scan(const std::string& path, const std::vector<std::string>& locales) {
+    Tmx_Strings tmx;
+    tmx.file_ = std::make_unique<Mapped_File>(Mapped_File::map(path));
+    for (const auto& locale : locales) {
+        tmx.locales_.emplace_back(locale, Locale_Strings{});
+    }
+
+    // string_view::find looks for the first char with memchr, most of the file is skipped that way
+    const std::string_view doc = tmx.file_->view();
+    const char* const doc_end = doc.data() + doc.size();
+    size_t at = 0;
+    while ((at = doc.find(s_common_fmt, at)) != std::string_view::npos) {
+        const size_t value_start = at;
+        at += s_common_fmt.size();
+
+        // only a quoted attribute value of a unit, <tu tuid="IDS_PERSONALITY_NAME_<id>">
+        if (value_start == 0 || (doc[value_start - 1] != '"' && doc[value_start - 1] != '\'')) {
+            continue;
+        }
+        const char quote = doc[value_start - 1];
+
+        bool is_name = false;
+        if (starts_with(doc.substr(at), s_name_fmt)) {
+            is_name = true;
+            at += s_name_fmt.size();
+        } else if (starts_with(doc.substr(at), s_effect_fmt)) {
+            at += s_effect_fmt.size();
+        } else {
+            continue;
+        }
+
+        int id{};
+        auto [id_end, ec] = std::from_chars(doc.data() + at, doc_end, id);
+        if (ec != std::errc{} || id_end == doc_end || *id_end != quote) {
+            continue;
+        }
+        at = static_cast<size_t>(id_end - doc.data());
+
+        const size_t tag = doc.rfind('<', value_start);
+        if (tag == std::string_view::npos || doc.compare(tag, 3, "<tu") != 0 || !is_space(doc[tag + 3])) {
+            continue;
+        }
+
+        const size_t unit_end = doc.find("</tu>", at);
+        if (unit_end == std::string_view::npos) {
+            logger->warn("Unterminated translation unit in {}", path);
+            break;
+        }
+
+        tmx.scan_unit(doc.substr(at, unit_end - at), is_name, id);
+        at = unit_end;
+    }
+
+    return tmx;
+}
+
+void Tmx_Strings::scan_unit(std::string_view unit, bool is_name, int id) {
+    constexpr auto npos = std::string_view::npos;
+    bool first = true;
+    size_t at = 0;
+    while ((at = unit.find("<tuv", at)) != npos) {
+        const size_t tag_end = unit.find('>', at);
+        const size_t seg = tag_end == npos ? npos : unit.find("<seg", tag_end);
+        const size_t seg_open_end = seg == npos ? npos : unit.find('>', seg);
+        if (seg_open_end == npos) {
+            return;
+        }
+
+        const std::string_view lang = attribute_value(unit.substr(at, tag_end - at), "lang");
+        std::string_view text;
+        at = seg_open_end + 1;
+        if (unit[seg_open_end - 1] != '/') {   // <seg/> is empty
+            const size_t text_end = std::min(unit.find('<', at), unit.size());
+            text = unit.substr(at, text_end - at);
+            at = text_end;
+        }
+
+        for (auto& [locale, strings] : locales_) {
+            if (locale.empty() ? first : iequals(locale, lang)) {
+                (is_name ? strings.names : strings.descriptions).emplace(id, text);
+            }
+        }
+        first = false;
+    }
+}
+
+const Tmx_Strings::Locale_Strings* Tmx_Strings::locale(std::string_view locale) const {
+    auto found = std::find_if(locales_.begin(), locales_.end(),
+                              [locale](const auto& scanned) { return iequals(scanned.first, locale); });
+    return found != locales_.end() ? &found->second : nullptr;
+}
+
+std::string Tmx_Strings::decode(std::string_view segment) {
+    std::string out;
+    out.reserve(segment.size());
+
+    size_t at = 0;
+    while (at < segment.size()) {
+        const size_t amp = segment.find('&', at);
+        out.append(segment.substr(at, amp - at));
+        if (amp == std::string_view::npos) {
+            break;
+        }
+
+        const size_t semi = segment.find(';', amp);
+        if (semi == std::string_view::npos) {
+            out.append(segment.substr(amp));
+            break;
+        }
+
+        const std::string_view entity = segment.substr(amp + 1, semi - amp - 1);
+        if (entity == "lt") {
+            out += '<';
+        } else if (entity == "gt") {
+            out += '>';
+        } else if (entity == "amp") {
+            out += '&';
+        } else if (entity == "quot") {
+            out += '"';
+        } else if (entity == "apos") {
+            out += '\'';
+        } else {
+            // &#<decimal>; or &#x<hex>;, anything else is kept as is
+            const bool hex = entity.size() > 2 && entity[0] == '#' && (entity[1] == 'x' || entity[1] == 'X');
+            const std::string_view digits = entity.substr(std::min<size_t>(entity.size(), hex ? 2 : 1));
+            uint32_t cp{};
+            auto [end, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), cp, hex ? 16 : 10);
+            if (!entity.empty() && entity[0] == '#' && !digits.empty() && ec == std::errc{} &&
+                end == digits.data() + digits.size() && cp <= 0x10FFFF) {
+                append_utf8(out, cp);
+            } else {
+                out.append(segment.substr(amp, semi - amp + 1));
+            }
+        }
+        at = semi + 1;
+    }
+
+    return out;
+}
+
+}   // namespace railcord
@@ -0,0 +1,42 @@
+#ifndef TMX_SCANNER_H
+#define TMX_SCANNER_H
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "gamedata_cache.h"
+
+namespace railcord {
+
+// Personality names and effect templates of a TMX file, found by scanning the mapped file for their unit ids
+// instead of building a DOM. Segments are views into the mapping and still hold their xml entities
+class Tmx_Strings {
+  public:
+    struct Locale_Strings {
+        std::unordered_map<int, std::string_view> names;
+        std::unordered_map<int, std::string_view> descriptions;
+    };
+
+    // One pass for every locale, an empty locale takes the first translation of each unit. Throws if the file
+    // can't be read
+    static Tmx_Strings scan(const std::string& path, const std::vector<std::string>& locales = {""});
+
+    const Locale_Strings* locale(std::string_view locale) const;   // nullptr if it was not scanned
+
+    // Segment text with its entities resolved
+    static std::string decode(std::string_view segment);
+
+  private:
+    void scan_unit(std::string_view unit, bool is_name, int id);
+
+    std::unique_ptr<Mapped_File> file_;   // the views need a stable mapping
+    std::vector<std::pair<std::string, Locale_Strings>> locales_;
+};
+
+}   // namespace railcord
+
+#endif   // !TMX_SCANNER_H
@@ -5,8 +5,13 @@
 #define _CRT_SECURE_NO_WARNINGS
 #endif
 
+#include <fstream>
 #include <sstream>
 
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
 #include <cpr/cpr.h>
 #include <openssl/md5.h>
 
@@ -63,7 +68,7 @@ std::string md5(const std::string& str) {
     return ss.str();
 }
 
-dpp::timer make_alert(dpp::cluster* bot, const Alert_Data& data, MessageTracker* sent_msgs) {
+void send_alert(dpp::cluster* bot, const Alert_Data& data, MessageTracker* sent_msgs) {
 
     auto delete_delay =
         static_cast<uint64_t>((static_cast<unsigned>(data.interval) * 60u) + MessageTracker::s_delete_message_delay -
@@ -79,19 +84,14 @@ dpp::timer make_alert(dpp::cluster* bot, const Alert_Data& data, MessageTracker*
         }
     };
 
-    auto send_msg = std::make_shared<std::function<void()>>([bot, delete_msg, msg = data.msg]() {
-        bot->message_create(msg, delete_msg);
-    });
-
-    return util::one_shot_timer(
-        bot, [send_msg]() { (*send_msg)(); }, data.seconds);
+    bot->message_create(data.msg, delete_msg);
 }
 
 dpp::embed build_embed(std::chrono::system_clock::time_point ends_at, const personality& p, bool with_timer) {
     using namespace std::chrono;
 
-    dpp::embed e;
-    const auto& art_url = p.get_art_url();
+    // everything but the auction times is prebuilt by the gamedata
+    dpp::embed e{p.embed_template()};
     if (with_timer) {
         std::string desc{};
         desc.reserve(64);
@@ -99,52 +99,39 @@ dpp::embed build_embed(std::chrono::system_clock::time_point ends_at, const pers
         e.set_description(desc);
     }
 
-    e.add_field("", p.description);
-
-    dpp::embed_author author;
-    author.icon_url = art_url;
-    author.name = p.name;
-    e.set_author(author);
-
-    dpp::embed_footer footer{};
-    footer.set_text(s_inv_space);
-
-    e.set_image(*p.main_icon);
-    footer.set_icon(*p.sec_icon);
-
-    e.set_footer(footer);
     e.set_timestamp(system_clock::to_time_t(ends_at));
-    e.set_thumbnail(art_url);
-
     return e;
 }
 
-dpp::message build_license_msg(License::Embed_Data* eb) {
+std::vector<dpp::message> build_license_msgs(License::Embed_Data* eb) {
     dpp::embed e;
     // e.set_image(good->icon);
-    e.set_thumbnail(eb->good->icon_url);
+    e.set_thumbnail(std::string{eb->good->icon_url});
     e.add_field("License", fmt::format("The auction for {} will end soon {}", eb->good->name,
                                        timepoint_to_discord_timestamp(eb->end_tp)));
     e.add_field("Minimum price", std::to_string(eb->license->min_price));
     e.add_field("Amount", std::to_string(eb->license->count).append("x"));
 
     dpp::embed_author author;
-    author.icon_url = eb->good->icon_url;
-    author.name = eb->good->name;
+    author.icon_url = std::string{eb->good->icon_url};
+    author.name = std::string{eb->good->name};
     e.set_author(author);
 
-    dpp::message m;
-    m.allowed_mentions.parse_users = true;
-    std::string mentions;
-    mentions.reserve(eb->users.size() * 10);
+    std::vector<dpp::message> msgs(1);
+    msgs.front().add_embed(e);
+
     for (const auto& u : eb->users) {
-        mentions.append(user_mention(u));
+        const std::string mention = user_mention(u);
+        if (msgs.back().content.size() + mention.size() > s_max_content) {
+            msgs.emplace_back();
+        }
+        msgs.back().content.append(mention);
     }
 
-    m.set_content(mentions);
-    m.add_embed(e);
-
-    return m;
+    for (auto& m : msgs) {
+        m.allowed_mentions.parse_users = true;
+    }
+    return msgs;
 }
 
 std::string request(const std::string& url, int timeout) {
@@ -162,6 +149,21 @@ std::string request(const std::string& url, int timeout) {
     return r.text;
 }
 
+dpp::task<std::string> co_request(dpp::cluster* bot, std::string url, uint16_t timeout) {
+    dpp::http_request_completion_t r = co_await bot->co_request(url, dpp::m_get, "", "text/plain", {}, "1.1", timeout);
+
+    if (r.error != dpp::h_success) {
+        logger->warn("request failed with error={}, url={}", static_cast<int>(r.error), url);
+        co_return std::string{};
+    }
+    if (r.status != 200) {
+        logger->warn("request failed with status code={}, url={}", r.status, url);
+        co_return std::string{};
+    }
+
+    co_return std::move(r.body);
+}
+
 std::string fmt_http_request(const std::string& server, int port, const std::string& endpoint, bool https) {
     std::string url = https ? "https://" : "http://";
     const std::string str_port = std::to_string(port);
@@ -169,6 +171,17 @@ std::string fmt_http_request(const std::string& server, int port, const std::str
     return url.append(server).append(":").append(str_port).append("/").append(endpoint);
 }
 
+std::optional<uint64_t> resident_memory() {
+#ifdef __linux__
+    std::ifstream statm{"/proc/self/statm"};
+    uint64_t size{}, resident{};
+    if (statm >> size >> resident) {
+        return resident * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    }
+#endif
+    return {};
+}
+
 uint32_t rnd_color() {
     // Generate a random uint32_t value
     return rnd_gen([&](auto& gen) {
@@ -5,9 +5,12 @@
 #include <chrono>
 #include <cstdint>
 #include <functional>
+#include <optional>
 #include <random>
 #include <string>
+#include <string_view>
 #include <time.h>
+#include <vector>
 
 // clang-format off
 #include <dpp/json.h>
@@ -27,6 +30,7 @@ class MessageTracker;
 namespace railcord::util {
 
 inline constexpr auto s_inv_space = "‎";
+inline constexpr size_t s_max_content = 2000;   // discord message content limit
 
 std::tm get_localtime(std::time_t* tt);
 std::chrono::system_clock::duration left_to_next_hour(std::chrono::system_clock::time_point tp);
@@ -34,12 +38,16 @@ std::chrono::system_clock::duration left_to_next_hour(std::chrono::system_clock:
 std::string get_token(const std::string& token_file);
 std::string md5(const std::string& str);
 
-dpp::timer make_alert(dpp::cluster* bot, const Alert_Data& data, MessageTracker* sent_msgs);
+void send_alert(dpp::cluster* bot, const Alert_Data& data, MessageTracker* sent_msgs);
 dpp::embed build_embed(std::chrono::system_clock::time_point tp, const personality& p, bool with_timer = false);
-dpp::message build_license_msg(License::Embed_Data* eb);
+// The embed goes with the first message, the mentions are split so each message stays under the content limit
+std::vector<dpp::message> build_license_msgs(License::Embed_Data* eb);
 
 std::string request(const std::string& url, int timeout = 10);
+// Same as request, through the cluster. timeout is in seconds
+dpp::task<std::string> co_request(dpp::cluster* bot, std::string url, uint16_t timeout = 10);
 std::string fmt_http_request(const std::string& server, int port, const std::string& endpoint, bool https = false);
+std::optional<uint64_t> resident_memory();   // bytes, only known on linux
 uint32_t rnd_color();
 std::string rnd_emoji(uint32_t idx = 0);
 uint32_t rnd_gen(std::function<uint32_t(std::mt19937& gen)> f);
@@ -105,6 +113,50 @@ std::string fmt_to_hr_min_sec(Duration d) {
     return tmp;
 }
 
+// Logs the time taken by each phase of a sequence and the total once finished
+class Phase_Timer {
+  public:
+    explicit Phase_Timer(std::string name)
+        : name_(std::move(name)), start_(std::chrono::steady_clock::now()), last_(start_) {}
+
+    void lap(const char* phase) {
+        auto now = std::chrono::steady_clock::now();
+        logger->info("{}: {} took {:.3f}s", name_, phase, secs(now - last_));
+        last_ = now;
+    }
+
+    void finish() { logger->info("{}: total {:.3f}s", name_, secs(std::chrono::steady_clock::now() - start_)); }
+
+  private:
+    static float secs(std::chrono::steady_clock::duration d) {
+        return std::chrono::duration_cast<std::chrono::duration<float>>(d).count();
+    }
+
+    std::string name_;
+    std::chrono::steady_clock::time_point start_;
+    std::chrono::steady_clock::time_point last_;
+};
+
+// Calls fn for every trimmed, non empty entry of a comma separated list
+template <typename Fn>
+void for_each_entry(std::string_view list, Fn&& fn) {
+    while (!list.empty()) {
+        auto end = std::min(list.find(','), list.size());
+        std::string_view entry = list.substr(0, end);
+        list.remove_prefix(std::min(end + 1, list.size()));
+
+        while (!entry.empty() && entry.front() == ' ') {
+            entry.remove_prefix(1);
+        }
+        while (!entry.empty() && entry.back() == ' ') {
+            entry.remove_suffix(1);
+        }
+        if (!entry.empty()) {
+            fn(entry);
+        }
+    }
+}
+
 inline std::string user_mention(dpp::snowflake user) {
     return std::string{}.append("<@").append(std::to_string(user)).append(">");
 }
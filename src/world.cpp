@@ -0,0 +1,152 @@
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+
+#include <INIReader.h>
+
+#include "gamedata_registry.h"
+#include "logger.h"
+#include "metrics.h"
+#include "util.h"
+#include "world.h"
+
+namespace railcord {
+
+static bool valid_world_name(std::string_view name) {
+    const auto valid_char = [](unsigned char c) { return std::isalnum(c) || c == '_' || c == '-'; };
+    return !name.empty() && std::all_of(name.begin(), name.end(), valid_char);
+}
+
+/// ---------------------------------------- World_Config ---------------------------------------
+#pragma region World_Config
+
+World_Config World_Config::load(const INIReader& settings, const std::string& name, bool main) {
+    const std::string section = main ? "Lucy" : "World." + name;
+    const auto get = [&](const char* key) {
+        std::string value = settings.Get(section, key, "");
+        return value.empty() && !main ? settings.Get("Lucy", key, "") : value;
+    };
+    const auto get_u64 = [&](const char* key, uint64_t fallback) {
+        const std::string value = get(key);
+        uint64_t n{};
+        if (std::from_chars(value.data(), value.data() + value.size(), n).ec != std::errc{}) {
+            return fallback;
+        }
+        return n;
+    };
+
+    World_Config config;
+    config.name = name;
+    if (auto mode = get("game_mode"); !mode.empty()) {
+        config.game_mode = std::move(mode);
+    }
+
+    std::string server = get("api_server");
+    if (server.empty()) {
+        server = "127.0.0.1";
+    }
+    const int port = static_cast<int>(get_u64("api_port", 6969));
+    const bool https = get_u64("https", 0);
+    config.personality_url = util::fmt_http_request(server, port, get("personality_endpoint"), https);
+    config.sync_time_url = util::fmt_http_request(server, port, get("sync_time_endpoint"), https);
+
+    if (!main) {
+        config.state_file = "state." + name + ".json";
+    }
+    config.channel = get_u64("channel", 0);
+    config.alert_role = get_u64("alert_role", 0);
+    config.board = get_u64("board", 0);
+    config.use_local_time = get_u64("use_local_time", 1);
+    return config;
+}
+
+#pragma endregion World_Config
+
+/// ---------------------------------------- World ---------------------------------------
+#pragma region World
+
+World::World(dpp::cluster* bot, GameData_Registry* registry, const World_Config& config)
+    : name_(config.name), game_mode_(config.game_mode), alert_manager_(bot, config.state_file),
+      watcher_(bot, registry, &alert_manager_, config.name) {
+    alert_manager_.set_alert_channel(config.channel);
+    alert_manager_.set_alert_role(config.alert_role);
+    alert_manager_.set_board_enabled(config.board);
+
+    watcher_.set_game_mode(game_mode_);
+    watcher_.set_endpoints(config.personality_url, config.sync_time_url);
+    watcher_.set_using_local_time(config.use_local_time);
+
+    metrics.gauge_fn(
+        "lucy_active_auctions", "Auctions running in the gameworld", {{"world", name_}},
+        [this]() { return static_cast<double>(alert_manager_.active_auction_count()); }, this);
+    metrics.gauge_fn(
+        "lucy_armed_timers", "Alert timers of the active auctions", {{"world", name_}},
+        [this]() { return static_cast<double>(alert_manager_.armed_timer_count()); }, this);
+    metrics.gauge_fn(
+        "lucy_tracked_messages", "Sent messages waiting for their deletion", {{"owner", "alerts"}, {"world", name_}},
+        [this]() { return static_cast<double>(alert_manager_.tracked_message_count()); }, this);
+}
+
+World::~World() { metrics.remove(this); }
+
+#pragma endregion World
+
+/// ---------------------------------------- World_Set ---------------------------------------
+#pragma region World_Set
+
+void World_Set::configure(const INIReader& settings) {
+    std::string main_name = settings.Get("Lucy", "world", "");
+    if (main_name.empty()) {
+        main_name = s_default_main;
+    }
+    worlds_.push_back(std::make_unique<World>(bot_, registry_, World_Config::load(settings, main_name, true)));
+
+    util::for_each_entry(settings.Get("Lucy", "worlds", ""), [&](std::string_view entry) {
+        std::string name{entry};
+        if (!valid_world_name(name) || get(name)) {
+            logger->warn("Ignoring world \"{}\", names must be unique and only use letters, digits, _ and -", name);
+            return;
+        }
+        if (!settings.HasSection("World." + name)) {
+            logger->warn("Ignoring world \"{}\", there is no [World.{}] section", name, name);
+            return;
+        }
+        worlds_.push_back(std::make_unique<World>(bot_, registry_, World_Config::load(settings, name, false)));
+    });
+
+    logger->info("Configured {} world(s)", worlds_.size());
+}
+
+bool World_Set::load_state() {
+    bool ok = true;
+    for (auto& w : worlds_) {
+        ok = w->alert_manager()->load_state() && ok;
+    }
+    return ok;
+}
+
+bool World_Set::save_state() {
+    bool ok = true;
+    for (auto& w : worlds_) {
+        ok = w->alert_manager()->save_state() && ok;
+    }
+    return ok;
+}
+
+World* World_Set::get(std::string_view name) {
+    if (name.empty()) {
+        return worlds_.empty() ? nullptr : worlds_.front().get();
+    }
+
+    auto found = std::find_if(worlds_.begin(), worlds_.end(), [name](const auto& w) { return w->name() == name; });
+    return found != worlds_.end() ? found->get() : nullptr;
+}
+
+size_t World_Set::index_of(const World* world) const {
+    auto found = std::find_if(worlds_.begin(), worlds_.end(), [world](const auto& w) { return w.get() == world; });
+    return static_cast<size_t>(found - worlds_.begin());
+}
+
+#pragma endregion World_Set
+
+}   // namespace railcord
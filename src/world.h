@@ -0,0 +1,85 @@
+#ifndef WORLD_H
+#define WORLD_H
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <dpp/dpp.h>
+
+#include "alert_manager.h"
+#include "personality_watcher.h"
+
+class INIReader;
+
+namespace railcord {
+
+class GameData_Registry;
+
+// Settings of one gameworld. The main world is read from [Lucy], the others from [World.<name>] where missing keys
+// fall back to [Lucy]
+struct World_Config {
+    std::string name;
+    std::string game_mode{"classic"};
+    std::string personality_url;
+    std::string sync_time_url;
+    std::string state_file{s_alert_manager_file};
+    dpp::snowflake channel;
+    dpp::snowflake alert_role;
+    bool board{false};
+    bool use_local_time{true};
+
+    static World_Config load(const INIReader& settings, const std::string& name, bool main);
+};
+
+// A watched gameworld, with its own clock offset, seen auctions and alert routing
+class World {
+  public:
+    World(dpp::cluster* bot, GameData_Registry* registry, const World_Config& config);
+    World(const World&) = delete;
+    World& operator=(const World&) = delete;
+    ~World();
+
+    const std::string& name() const { return name_; }
+    const std::string& game_mode() const { return game_mode_; }
+    Alert_Manager* alert_manager() { return &alert_manager_; }
+    personality_watcher* watcher() { return &watcher_; }
+
+  private:
+    std::string name_;
+    std::string game_mode_;
+    Alert_Manager alert_manager_;
+    personality_watcher watcher_;   // after alert_manager_, it stops before the manager goes
+};
+
+// The worlds of this bot. Their watchers are coroutines on the one cluster, so they share its timers, its HTTP
+// request queue and its gateway connection
+class World_Set {
+  public:
+    World_Set(dpp::cluster* bot, GameData_Registry* registry) : bot_(bot), registry_(registry) {}
+    World_Set(const World_Set&) = delete;
+    World_Set& operator=(const World_Set&) = delete;
+
+    // The main world from [Lucy] and one per name in [Lucy] worlds, only once before the commands are loaded
+    void configure(const INIReader& settings);
+    bool load_state();
+    bool save_state();
+
+    World& main() { return *worlds_.front(); }
+    World* get(std::string_view name);   // the main world for an empty name, null if unknown
+    World* at(size_t index) { return index < worlds_.size() ? worlds_[index].get() : nullptr; }
+    size_t index_of(const World* world) const;   // the position in all(), component ids carry it
+    const std::vector<std::unique_ptr<World>>& all() const { return worlds_; }
+
+    static constexpr const char* s_default_main = "main";
+
+  private:
+    dpp::cluster* bot_;
+    GameData_Registry* registry_;
+    std::vector<std::unique_ptr<World>> worlds_;
+};
+
+}   // namespace railcord
+
+#endif   // !WORLD_H